@@ -31,7 +31,7 @@ void Status::Flush(Type t) {
   } else if (t == INFO) {
      s += "I:";
   }
-  char buf[10];
+  char buf[16];
   if (context->ln_ > -1) {
     sprintf(buf, "%d", context->ln_);
     s += string("(line: ") + buf + ")";
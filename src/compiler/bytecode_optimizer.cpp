@@ -0,0 +1,599 @@
+#include "compiler/bytecode_optimizer.h"
+
+#include "base/status.h"
+#include "vm/insn.h"
+#include "vm/method.h"
+#include "vm/opcode.h"
+#include "vm/register.h"
+
+#include <map>
+using std::map;
+
+namespace compiler {
+
+static const int kMaxIterations = 4;
+
+ByteCodeOptimizer::ByteCodeOptimizer(vm::Method *method) : method_(method) {
+}
+
+void ByteCodeOptimizer::Optimize() {
+  static const char *pass_names[] = {
+    "constant folding", "copy propagation",
+    "dead register removal", "jump threading"};
+  int (ByteCodeOptimizer::*passes[])() = {
+    &ByteCodeOptimizer::FoldConstants,
+    &ByteCodeOptimizer::PropagateCopies,
+    &ByteCodeOptimizer::RemoveDeadRegisters,
+    &ByteCodeOptimizer::ThreadJumps};
+  const int num_passes = sizeof(passes) / sizeof(passes[0]);
+  int num_removed[num_passes] = {0};
+  for (int iter = 0; iter < kMaxIterations; ++iter) {
+    bool changed = false;
+    for (int p = 0; p < num_passes; ++p) {
+      size_t num_insns = method_->insns_.size();
+      if ((this->*passes[p])() > 0) {
+	changed = true;
+      }
+      num_removed[p] += num_insns - method_->insns_.size();
+    }
+    if (!changed) {
+      break;
+    }
+  }
+  for (int p = 0; p < num_passes; ++p) {
+    LOG(INFO) << "ByteCodeOptimizer: " << pass_names[p] << " removed "
+	      << num_removed[p] << " insns";
+  }
+  int num_regs = CoalesceRegisters();
+  LOG(INFO) << "ByteCodeOptimizer: register coalescing removed "
+	    << num_regs << " registers";
+}
+
+int ByteCodeOptimizer::FoldConstants() {
+  CountDefsAndUses();
+  int num_folded = 0;
+  for (vm::Insn *insn : method_->insns_) {
+    if (!insn->is_narrow_ || insn->src_regs_.size() != 2 ||
+	insn->dst_regs_.size() != 1) {
+      continue;
+    }
+    vm::Register *dst = insn->dst_regs_[0];
+    vm::Register *lhs = insn->src_regs_[0];
+    vm::Register *rhs = insn->src_regs_[1];
+    if (!IsLiteral(lhs) || !IsLiteral(rhs) ||
+	num_defs_[dst->id_] != 1 || IsArgOrReturn(dst)) {
+      continue;
+    }
+    // Same as Executor::ExecNarrowNumOp().
+    uint64_t l = lhs->initial_num_.GetValue0();
+    uint64_t r = rhs->initial_num_.GetValue0();
+    uint64_t mask = insn->narrow_mask_;
+    uint64_t v;
+    switch (insn->op_) {
+    case vm::OP_ADD:
+      v = (l + r) & mask;
+      break;
+    case vm::OP_SUB:
+      v = (l - r) & mask;
+      break;
+    case vm::OP_MUL:
+      v = (l * r) & mask;
+      break;
+    case vm::OP_AND:
+      v = l & r;
+      break;
+    case vm::OP_OR:
+      v = l | r;
+      break;
+    case vm::OP_XOR:
+      v = l ^ r;
+      break;
+    case vm::OP_LSHIFT:
+      v = r < 64 ? ((l << r) & mask) : 0;
+      break;
+    case vm::OP_RSHIFT:
+      v = r < 64 ? ((l >> r) & mask) : 0;
+      break;
+    default:
+      // Comparisons produce bool values.
+      continue;
+    }
+    dst->initial_num_.SetValue0(v);
+    dst->initial_num_.type_ = dst->type_.width_;
+    dst->type_.is_const_ = true;
+    dst->SetIsDeclaredType(true);
+    // using same register for src/dst (same as ExprCompiler).
+    insn->op_ = vm::OP_NUM;
+    insn->src_regs_.clear();
+    insn->src_regs_.push_back(dst);
+    insn->is_narrow_ = false;
+    ++num_folded;
+  }
+  return num_folded;
+}
+
+int ByteCodeOptimizer::PropagateCopies() {
+  auto &insns = method_->insns_;
+  vector<bool> targets;
+  CollectJumpTargets(&targets);
+  int num_changes = 0;
+  // Forwards copies within each basic block.
+  map<vm::Register *, vm::Register *> copies;
+  for (size_t i = 0; i < insns.size(); ++i) {
+    vm::Insn *insn = insns[i];
+    if (targets[i]) {
+      copies.clear();
+    }
+    if (IsPure(insn) || insn->op_ == vm::OP_IF ||
+	insn->op_ == vm::OP_FUNCALL || insn->op_ == vm::OP_ARRAY_READ ||
+	insn->op_ == vm::OP_ARRAY_WRITE) {
+      for (vm::Register *&src : insn->src_regs_) {
+	bool is_dst = false;
+	for (vm::Register *dst : insn->dst_regs_) {
+	  if (dst == src) {
+	    is_dst = true;
+	  }
+	}
+	auto it = copies.find(src);
+	if (!is_dst && it != copies.end()) {
+	  src = it->second;
+	  ++num_changes;
+	}
+      }
+    }
+    for (vm::Register *dst : insn->dst_regs_) {
+      for (auto it = copies.begin(); it != copies.end();) {
+	if (it->first == dst || it->second == dst) {
+	  it = copies.erase(it);
+	} else {
+	  ++it;
+	}
+      }
+    }
+    if (IsCopy(insn)) {
+      copies[insn->dst_regs_[0]] = insn->src_regs_[1];
+    }
+    if (insn->op_ == vm::OP_GOTO || insn->op_ == vm::OP_IF) {
+      copies.clear();
+    }
+  }
+
+  // Merges a temporary into the following copy.
+  CountDefsAndUses();
+  vector<bool> removed(insns.size(), false);
+  for (size_t i = 0; i + 1 < insns.size(); ++i) {
+    vm::Insn *insn = insns[i];
+    vm::Insn *copy = insns[i + 1];
+    if (removed[i] || targets[i + 1] || !IsCopy(copy)) {
+      continue;
+    }
+    if (!(WritesOnlyDst(insn) && insn->op_ != vm::OP_NUM &&
+	  insn->op_ != vm::OP_ASSIGN && insn->op_ != vm::OP_PRE_INC &&
+	  insn->op_ != vm::OP_PRE_DEC && insn->op_ != vm::OP_LOAD_OBJ)) {
+      continue;
+    }
+    vm::Register *tmp = copy->src_regs_[1];
+    vm::Register *var = copy->dst_regs_[0];
+    if (insn->dst_regs_.size() != 1 || insn->dst_regs_[0] != tmp ||
+	num_defs_[tmp->id_] != 1 || num_uses_[tmp->id_] != 1 ||
+	IsArgOrReturn(tmp) || insn->obj_reg_ == var) {
+      continue;
+    }
+    bool reads_var = false;
+    for (vm::Register *src : insn->src_regs_) {
+      if (src == var) {
+	reads_var = true;
+      }
+    }
+    if (reads_var) {
+      continue;
+    }
+    insn->dst_regs_[0] = var;
+    removed[i + 1] = true;
+    ++num_changes;
+  }
+  Compact(removed);
+  return num_changes;
+}
+
+void ByteCodeOptimizer::ComputeLiveness(vector<vector<bool> > *live_in,
+					vector<vector<bool> > *live_out) {
+  auto &insns = method_->insns_;
+  size_t num_insns = insns.size();
+  size_t num_regs = method_->method_regs_.size();
+  // (*live_in)[num_insns] is the live set at the exit.
+  live_in->assign(num_insns + 1, vector<bool>(num_regs, false));
+  int num_args = method_->GetNumArgRegisters();
+  int num_rets = method_->GetNumReturnRegisters();
+  for (int i = 0; i < num_rets; ++i) {
+    (*live_in)[num_insns][method_->method_regs_[i + num_args]->id_] = true;
+  }
+  live_out->assign(num_insns, vector<bool>(num_regs, false));
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int i = num_insns - 1; i >= 0; --i) {
+      vm::Insn *insn = insns[i];
+      vector<bool> &out = (*live_out)[i];
+      vector<bool> &next = (*live_in)[i + 1];
+      if (insn->op_ != vm::OP_GOTO) {
+	for (size_t r = 0; r < num_regs; ++r) {
+	  out[r] = out[r] || next[r];
+	}
+      }
+      if (insn->op_ == vm::OP_GOTO || insn->op_ == vm::OP_IF) {
+	vector<bool> &target = (*live_in)[insn->jump_target_];
+	for (size_t r = 0; r < num_regs; ++r) {
+	  out[r] = out[r] || target[r];
+	}
+      }
+      vector<bool> in = out;
+      if (WritesOnlyDst(insn)) {
+	for (vm::Register *dst : insn->dst_regs_) {
+	  in[dst->id_] = false;
+	}
+      }
+      vector<vm::Register *> uses;
+      GetUses(insn, &uses);
+      for (vm::Register *reg : uses) {
+	in[reg->id_] = true;
+      }
+      if (in != (*live_in)[i]) {
+	(*live_in)[i] = in;
+	changed = true;
+      }
+    }
+  }
+}
+
+int ByteCodeOptimizer::RemoveDeadRegisters() {
+  auto &insns = method_->insns_;
+  size_t num_insns = insns.size();
+  vector<vector<bool> > live_in;
+  vector<vector<bool> > live_out;
+  ComputeLiveness(&live_in, &live_out);
+  vector<bool> removed(num_insns, false);
+  int num_changes = 0;
+  // Keeps the last insn as a jump target.
+  for (size_t i = 0; i + 1 < num_insns; ++i) {
+    vm::Insn *insn = insns[i];
+    if (!IsPure(insn)) {
+      continue;
+    }
+    bool is_live = false;
+    for (vm::Register *dst : insn->dst_regs_) {
+      if (live_out[i][dst->id_]) {
+	is_live = true;
+      }
+    }
+    if (!is_live) {
+      removed[i] = true;
+      ++num_changes;
+    }
+  }
+  Compact(removed);
+  return num_changes;
+}
+
+int ByteCodeOptimizer::ThreadJumps() {
+  auto &insns = method_->insns_;
+  int num_insns = insns.size();
+  int num_changes = 0;
+  for (vm::Insn *insn : insns) {
+    if (insn->op_ != vm::OP_GOTO && insn->op_ != vm::OP_IF) {
+      continue;
+    }
+    int target = insn->jump_target_;
+    // Guards against a loop of gotos.
+    for (int i = 0; i < num_insns; ++i) {
+      vm::Insn *next = insns[target];
+      if (next->op_ != vm::OP_GOTO || next->jump_target_ == target) {
+	break;
+      }
+      target = next->jump_target_;
+    }
+    if (target != insn->jump_target_) {
+      insn->jump_target_ = target;
+      ++num_changes;
+    }
+  }
+  vector<bool> removed(num_insns, false);
+  for (int i = 0; i + 1 < num_insns; ++i) {
+    vm::Insn *insn = insns[i];
+    if (insn->op_ == vm::OP_NOP ||
+	((insn->op_ == vm::OP_GOTO || insn->op_ == vm::OP_IF) &&
+	 insn->jump_target_ == i + 1)) {
+      removed[i] = true;
+      ++num_changes;
+    }
+  }
+  Compact(removed);
+  return num_changes;
+}
+
+int ByteCodeOptimizer::CoalesceRegisters() {
+  auto &regs = method_->method_regs_;
+  size_t num_regs = regs.size();
+  vector<vector<bool> > live_in;
+  vector<vector<bool> > live_out;
+  ComputeLiveness(&live_in, &live_out);
+  CountDefsAndUses();
+  // Registers conflict if one is written while the other is live.
+  vector<vector<bool> > conflicts(num_regs, vector<bool>(num_regs, false));
+  for (size_t i = 0; i < method_->insns_.size(); ++i) {
+    vm::Insn *insn = method_->insns_[i];
+    for (vm::Register *dst : insn->dst_regs_) {
+      for (size_t r = 0; r < num_regs; ++r) {
+	if (live_out[i][r]) {
+	  conflicts[dst->id_][r] = true;
+	  conflicts[r][dst->id_] = true;
+	}
+      }
+      for (vm::Register *other : insn->dst_regs_) {
+	conflicts[dst->id_][other->id_] = true;
+      }
+      if (insn->is_narrow_) {
+	// ExecNarrowNumOp() reads the operands before the write.
+	continue;
+      }
+      vector<vm::Register *> uses;
+      GetUses(insn, &uses);
+      for (vm::Register *src : uses) {
+	conflicts[dst->id_][src->id_] = true;
+	conflicts[src->id_][dst->id_] = true;
+      }
+    }
+  }
+  // Greedily merges each temporary into the first compatible one.
+  vector<vm::Register *> rep_regs(num_regs);
+  vector<vector<int> > merged(num_regs);
+  vector<int> candidates;
+  for (size_t r = 0; r < num_regs; ++r) {
+    vm::Register *reg = regs[r];
+    rep_regs[r] = reg;
+    // An unused register can't represent others, since it is dropped.
+    if (!IsCoalescable(reg) || live_in[0][r] ||
+	(num_defs_[r] == 0 && num_uses_[r] == 0)) {
+      continue;
+    }
+    for (int c : candidates) {
+      if (!IsSameType(regs[c], reg)) {
+	continue;
+      }
+      bool has_conflict = false;
+      for (int m : merged[c]) {
+	if (conflicts[m][r]) {
+	  has_conflict = true;
+	}
+      }
+      if (!has_conflict) {
+	rep_regs[r] = regs[c];
+	merged[c].push_back(r);
+	break;
+      }
+    }
+    if (rep_regs[r] == reg) {
+      candidates.push_back(r);
+      merged[r].push_back(r);
+    }
+  }
+  // Rewrites operands. (MethodSynth maps the merged registers to one
+  // IRegister, since they have the same type.)
+  for (vm::Insn *insn : method_->insns_) {
+    for (vm::Register *&reg : insn->src_regs_) {
+      reg = rep_regs[reg->id_];
+    }
+    for (vm::Register *&reg : insn->dst_regs_) {
+      reg = rep_regs[reg->id_];
+    }
+    if (insn->obj_reg_ != nullptr) {
+      insn->obj_reg_ = rep_regs[insn->obj_reg_->id_];
+    }
+  }
+  // Drops merged and unused registers, then renumbers the rest.
+  vector<vm::Register *> kept;
+  for (size_t r = 0; r < num_regs; ++r) {
+    vm::Register *reg = regs[r];
+    bool is_used = (num_defs_[r] > 0 || num_uses_[r] > 0);
+    if (rep_regs[r] == reg && (is_used || IsArgOrReturn(reg))) {
+      reg->id_ = kept.size();
+      kept.push_back(reg);
+    } else {
+      delete reg;
+    }
+  }
+  int num_removed = num_regs - kept.size();
+  regs = kept;
+  return num_removed;
+}
+
+void ByteCodeOptimizer::CountDefsAndUses() {
+  size_t num_regs = method_->method_regs_.size();
+  num_defs_.assign(num_regs, 0);
+  num_uses_.assign(num_regs, 0);
+  def_insns_.assign(num_regs, nullptr);
+  for (vm::Insn *insn : method_->insns_) {
+    for (vm::Register *dst : insn->dst_regs_) {
+      CHECK(dst->id_ < (int)num_regs);
+      ++num_defs_[dst->id_];
+      def_insns_[dst->id_] = insn;
+    }
+    vector<vm::Register *> uses;
+    GetUses(insn, &uses);
+    for (vm::Register *reg : uses) {
+      ++num_uses_[reg->id_];
+    }
+  }
+}
+
+void ByteCodeOptimizer::CollectJumpTargets(vector<bool> *targets) {
+  targets->assign(method_->insns_.size(), false);
+  for (vm::Insn *insn : method_->insns_) {
+    if (insn->op_ == vm::OP_GOTO || insn->op_ == vm::OP_IF) {
+      (*targets)[insn->jump_target_] = true;
+    }
+  }
+}
+
+bool ByteCodeOptimizer::IsLiteral(vm::Register *reg) {
+  // NOTE: is_const_ is also set to declared variables.
+  if (reg->type_.value_type_ != vm::Value::NUM ||
+      num_defs_[reg->id_] != 1) {
+    return false;
+  }
+  vm::Insn *def = def_insns_[reg->id_];
+  if (def->op_ != vm::OP_NUM || def->src_regs_[0] != reg) {
+    return false;
+  }
+  const iroha::NumericWidth &w = reg->initial_num_.type_;
+  return (!w.IsWide() &&
+	  w.GetWidth() == reg->type_.width_.GetWidth() &&
+	  w.IsSigned() == reg->type_.width_.IsSigned());
+}
+
+bool ByteCodeOptimizer::IsCoalescable(vm::Register *reg) {
+  // Named variables and constants get their own IRegister in MethodSynth.
+  if (reg->orig_name_ != sym_null || reg->type_.is_const_ ||
+      reg->type_object_ != nullptr || IsArgOrReturn(reg)) {
+    return false;
+  }
+  if (reg->type_.value_type_ != vm::Value::NUM &&
+      reg->type_.value_type_ != vm::Value::ENUM_ITEM) {
+    return false;
+  }
+  vm::Insn *def = def_insns_[reg->id_];
+  return def == nullptr || def->op_ != vm::OP_NUM;
+}
+
+bool ByteCodeOptimizer::IsArgOrReturn(vm::Register *reg) {
+  int n = method_->GetNumArgRegisters() + method_->GetNumReturnRegisters();
+  for (int i = 0; i < n; ++i) {
+    if (method_->method_regs_[i] == reg) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int ByteCodeOptimizer::Compact(const vector<bool> &removed) {
+  auto &insns = method_->insns_;
+  // new_index[i] is the index of the first surviving insn at or after i.
+  vector<int> new_index(insns.size() + 1);
+  vector<vm::Insn *> kept;
+  for (size_t i = 0; i < insns.size(); ++i) {
+    new_index[i] = kept.size();
+    if (removed[i]) {
+      delete insns[i];
+    } else {
+      kept.push_back(insns[i]);
+    }
+  }
+  new_index[insns.size()] = kept.size();
+  int num_removed = insns.size() - kept.size();
+  for (vm::Insn *insn : kept) {
+    if (insn->jump_target_ > -1) {
+      insn->jump_target_ = new_index[insn->jump_target_];
+    }
+  }
+  insns = kept;
+  return num_removed;
+}
+
+bool ByteCodeOptimizer::IsPure(vm::Insn *insn) {
+  switch (insn->op_) {
+  case vm::OP_NUM:
+  case vm::OP_ASSIGN:
+  case vm::OP_ADD:
+  case vm::OP_SUB:
+  case vm::OP_MUL:
+  case vm::OP_AND:
+  case vm::OP_OR:
+  case vm::OP_XOR:
+  case vm::OP_LSHIFT:
+  case vm::OP_RSHIFT:
+  case vm::OP_CONCAT:
+  case vm::OP_BIT_RANGE:
+  case vm::OP_LT:
+  case vm::OP_GT:
+  case vm::OP_LTE:
+  case vm::OP_GTE:
+  case vm::OP_EQ:
+  case vm::OP_NE:
+  case vm::OP_LAND:
+  case vm::OP_LOR:
+  case vm::OP_BIT_INV:
+  case vm::OP_LOGIC_INV:
+  case vm::OP_PLUS:
+  case vm::OP_MINUS:
+  case vm::OP_PRE_INC:
+  case vm::OP_PRE_DEC:
+    // OP_DIV is not here, since it can fail.
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool ByteCodeOptimizer::WritesOnlyDst(vm::Insn *insn) {
+  if (IsPure(insn)) {
+    return true;
+  }
+  return (insn->op_ == vm::OP_DIV ||
+	  insn->op_ == vm::OP_FUNCALL_DONE ||
+	  insn->op_ == vm::OP_ARRAY_READ ||
+	  insn->op_ == vm::OP_MEMBER_READ ||
+	  insn->op_ == vm::OP_LOAD_OBJ);
+}
+
+bool ByteCodeOptimizer::IsSameType(vm::Register *r1, vm::Register *r2) {
+  const vm::RegisterType &t1 = r1->type_;
+  const vm::RegisterType &t2 = r2->type_;
+  // is_const_ is ignored, since it is also set to declared variables.
+  return (t1.value_type_ == t2.value_type_ &&
+	  t1.enum_type_ == t2.enum_type_ &&
+	  t1.width_.GetWidth() == t2.width_.GetWidth() &&
+	  t1.width_.IsSigned() == t2.width_.IsSigned() &&
+	  t1.object_name_ == t2.object_name_ &&
+	  r1->type_object_ == r2->type_object_);
+}
+
+void ByteCodeOptimizer::GetUses(vm::Insn *insn,
+				vector<vm::Register *> *uses) {
+  for (size_t i = 0; i < insn->src_regs_.size(); ++i) {
+    vm::Register *src = insn->src_regs_[i];
+    if (i == 0 && insn->op_ == vm::OP_ASSIGN &&
+	insn->dst_regs_.size() == 1 && insn->dst_regs_[0] == src) {
+      // lhs of an assign is only written.
+      continue;
+    }
+    uses->push_back(src);
+  }
+  if (insn->obj_reg_ != nullptr) {
+    uses->push_back(insn->obj_reg_);
+  }
+  if (!WritesOnlyDst(insn)) {
+    // e.g. MEMBER_WRITE has the rhs in dst_regs_.
+    for (vm::Register *dst : insn->dst_regs_) {
+      uses->push_back(dst);
+    }
+  }
+}
+
+bool ByteCodeOptimizer::IsCopy(vm::Insn *insn) {
+  if (insn->op_ != vm::OP_ASSIGN || insn->src_regs_.size() != 2 ||
+      insn->dst_regs_.size() != 1) {
+    return false;
+  }
+  vm::Register *dst = insn->dst_regs_[0];
+  vm::Register *src = insn->src_regs_[1];
+  if (insn->src_regs_[0] != dst || src == dst) {
+    return false;
+  }
+  if (dst->type_.value_type_ != vm::Value::NUM &&
+      dst->type_.value_type_ != vm::Value::ENUM_ITEM) {
+    return false;
+  }
+  return IsSameType(dst, src) && dst->type_object_ == nullptr;
+}
+
+}  // namespace compiler
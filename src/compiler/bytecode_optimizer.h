@@ -0,0 +1,58 @@
+// -*- C++ -*-
+#ifndef _compiler_bytecode_optimizer_h_
+#define _compiler_bytecode_optimizer_h_
+
+#include "compiler/common.h"
+
+namespace compiler {
+
+// Rewrites the insns of a (non top level) method after the labels are
+// resolved. Each pass keeps insn_expr_/insn_stmt_ of the surviving insns
+// and fixes up jump_target_ when insns are removed.
+class ByteCodeOptimizer {
+public:
+  ByteCodeOptimizer(vm::Method *method);
+
+  void Optimize();
+
+private:
+  // Replaces a narrow binop of 2 literals with a num insn.
+  int FoldConstants();
+  // Forwards x in "x <- assign(x, y)" within basic blocks and merges
+  // "t <- op(...); x <- assign(x, t)" into "x <- op(...)".
+  int PropagateCopies();
+  // Removes pure insns whose results are never read.
+  int RemoveDeadRegisters();
+  // Retargets jumps to gotos and removes jumps to the next insn and nops.
+  int ThreadJumps();
+  // Shares a register among temporaries whose lifetimes don't overlap
+  // and drops unused registers. Returns the number of removed registers.
+  int CoalesceRegisters();
+
+  // (*live_in)[i] and (*live_out)[i] are indexed by vm::Register::id_.
+  void ComputeLiveness(vector<vector<bool> > *live_in,
+		       vector<vector<bool> > *live_out);
+  void CountDefsAndUses();
+  void CollectJumpTargets(vector<bool> *targets);
+  bool IsLiteral(vm::Register *reg);
+  bool IsCoalescable(vm::Register *reg);
+  bool IsArgOrReturn(vm::Register *reg);
+  // Deletes the marked insns and returns the number of them.
+  int Compact(const vector<bool> &removed);
+
+  static bool IsPure(vm::Insn *insn);
+  static bool WritesOnlyDst(vm::Insn *insn);
+  static bool IsSameType(vm::Register *r1, vm::Register *r2);
+  static void GetUses(vm::Insn *insn, vector<vm::Register *> *uses);
+  static bool IsCopy(vm::Insn *insn);
+
+  vm::Method *method_;
+  vector<int> num_defs_;
+  vector<int> num_uses_;
+  // The last insn which writes to each register.
+  vector<vm::Insn *> def_insns_;
+};
+
+}  // namespace compiler
+
+#endif  // _compiler_bytecode_optimizer_h_
@@ -1,6 +1,7 @@
 #include "compiler/method_compiler.h"
 
 #include "base/status.h"
+#include "compiler/bytecode_optimizer.h"
 #include "compiler/compiler.h"
 #include "compiler/expr_compiler.h"
 #include "compiler/reg_checker.h"
@@ -8,8 +9,10 @@
 #include "fe/method.h"
 #include "fe/stmt.h"
 #include "fe/var_decl.h"
+#include "karuta/env.h"
 #include "vm/insn.h"
 #include "vm/decl_annotator.h"
+#include "vm/executor/executor.h"
 #include "vm/insn_annotator.h"
 #include "vm/method.h"
 #include "vm/object.h"
@@ -95,6 +98,19 @@ void MethodCompiler::Compile() {
 
   if (Status::CheckAllErrors(false)) {
     method_->SetCompileFailure();
+    return;
+  }
+  if (Env::GetByteCodeOptimization() && !method_->IsTopLevel()) {
+    ByteCodeOptimizer optimizer(method_);
+    optimizer.Optimize();
+    if (vm::ByteCodeDebugMode::IsEnabled(dbg_bytecode_)) {
+      method_->Dump();
+    }
+  }
+  vm::executor::Executor::DecodeMethod(method_);
+  if (!method_->IsTopLevel()) {
+    // Types of top level registers can change during the execution.
+    method_->BuildRegValuesTemplate();
   }
 }
 
@@ -10,6 +10,9 @@
 #include "fe/method.h"
 #include "fe/nodecode.h"
 #include "fe/scanner.h"
+#include "fe/sweep.h"
+#include "vm/gc.h"
+#include "vm/inline_cache.h"
 #include "vm/method.h"
 #include "vm/object.h"
 #include "vm/thread.h"
@@ -168,18 +171,54 @@ void FE::Run(bool with_run, bool with_compile, bool vanilla,
     ok = RunFile(true, false, false, "default-isynth.karuta", &vm);
   }
   if (ok) {
-    for (size_t i = 0; i < files.size(); ++i) {
-      ok = RunFile(false, with_run, with_compile, files[i], &vm);
-      if (!ok) {
-	break;
+    if (!Env::GetSweepFile().empty()) {
+      RunSweep(with_run, with_compile, files, &vm);
+    } else {
+      for (size_t i = 0; i < files.size(); ++i) {
+	ok = RunFile(false, with_run, with_compile, files[i], &vm);
+	if (!ok) {
+	  break;
+	}
       }
     }
   }
   vm.GC();
+  if (Env::GetGCStats()) {
+    vm.GetGC()->DumpStats(cout);
+  }
+  if (Env::GetInlineCacheStats()) {
+    vm::InlineCache::DumpStats(cout);
+  }
 
   NodePool::Release();
 }
 
+void FE::RunSweep(bool with_run, bool with_compile,
+		  const vector<string> &files, vm::VM *vm) {
+  Sweep sweep;
+  if (!sweep.ReadConfigs(Env::GetSweepFile())) {
+    return;
+  }
+  // Parses once before fork() and each child compiles and runs them.
+  vector<Method *> parse_trees;
+  for (const string &file : files) {
+    Method *parse_tree = ReadFile(file, false);
+    if (parse_tree == nullptr) {
+      Status::os(Status::USER_ERROR) << "Failed to load: " << file;
+      return;
+    }
+    parse_trees.push_back(parse_tree);
+  }
+  if (sweep.Fork(vm) < 0) {
+    return;
+  }
+  bool ok = true;
+  for (size_t i = 0; i < files.size() && ok; ++i) {
+    ok = RunParseTree(with_run, with_compile, files[i], parse_trees[i], vm);
+  }
+  Sweep::ExitChild(ok);
+}
+
 vm::Method *FE::ImportFile(const string &file,
 			   vm::VM *vm, vm::Object *thr_obj) {
   return CompileFile(file, true, false, false, false, vm, thr_obj);
@@ -194,6 +233,14 @@ vm::Method *FE::CompileFile(const string &file, bool is_import,
     Status::os(Status::USER_ERROR) << "Failed to load: " << file;
     return nullptr;
   }
+  return CompileParseTree(file, parse_tree, with_run, with_compile,
+			  dbg_parser, vm, obj);
+}
+
+vm::Method *FE::CompileParseTree(const string &file, Method *parse_tree,
+				 bool with_run, bool with_compile,
+				 bool dbg_parser,
+				 vm::VM *vm, vm::Object *obj) {
   DumpStream ds(cout);
   if (dbg_parser) {
     parse_tree->Dump(ds);
@@ -216,11 +263,23 @@ bool FE::RunFile(bool is_import ,bool with_run, bool with_compile,
 		 const string &file,
 		 vm::VM *vm) {
   Env::SetCurrentFile(file);
+  Method *parse_tree = ReadFile(file, is_import);
+  if (parse_tree == nullptr) {
+    Status::os(Status::USER_ERROR) << "Failed to load: " << file;
+    return false;
+  }
+  return RunParseTree(with_run, with_compile, file, parse_tree, vm);
+}
+
+bool FE::RunParseTree(bool with_run, bool with_compile,
+		      const string &file, Method *parse_tree,
+		      vm::VM *vm) {
+  Env::SetCurrentFile(file);
   vm::Object *thr_obj = vm->kernel_object_->Clone();
-  vm::Method *method = CompileFile(file, is_import,
-				   with_run, with_compile,
-				   dbg_parser_,
-				   vm, thr_obj);
+  vm::Method *method = CompileParseTree(file, parse_tree,
+					with_run, with_compile,
+					dbg_parser_,
+					vm, thr_obj);
   if (method == nullptr || method->IsCompileFailure()) {
     return false;
   }
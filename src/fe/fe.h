@@ -22,12 +22,23 @@ class FE {
   bool RunFile(bool is_import, bool with_run, bool with_compile,
 	       const string &file,
 	       vm::VM *vm);
+  bool RunParseTree(bool with_run, bool with_compile,
+		    const string &file, Method *parse_tree,
+		    vm::VM *vm);
+  // Runs the files under each configuration of --sweep.
+  void RunSweep(bool with_run, bool with_compile,
+		const vector<string> &files, vm::VM *vm);
 
   static vm::Method *CompileFile(const string &file,
 				 bool is_import,
 				 bool with_run, bool with_compile,
 				 bool dbg_parser,
 				 vm::VM *vm, vm::Object *obj);
+  static vm::Method *CompileParseTree(const string &file,
+				      Method *parse_tree,
+				      bool with_run, bool with_compile,
+				      bool dbg_parser,
+				      vm::VM *vm, vm::Object *obj);
   static Method *ReadFile(const string &file, bool import);
   static void InitScannerInfo(ScannerInfo *s_info);
   static void InitSyms();
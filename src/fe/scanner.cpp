@@ -362,7 +362,7 @@ FileImage *Scanner::CreateFileImage(const char *fn) {
   free(buf);
   fclose(fp);
   if (s == 0) {
-    free(im);
+    delete im;
     return nullptr;
   }
   return im;
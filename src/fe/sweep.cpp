@@ -0,0 +1,182 @@
+#include "fe/sweep.h"
+
+#include "base/status.h"
+#include "vm/native_methods.h"
+#include "vm/object.h"
+#include "vm/object_util.h"
+#include "vm/vm.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fe {
+
+Sweep::Sweep() : num_running_(0) {
+}
+
+Sweep::~Sweep() {
+  for (Child &c : children_) {
+    if (c.output_ != nullptr) {
+      fclose(c.output_);
+    }
+  }
+}
+
+bool Sweep::ReadConfigs(const string &fn) {
+  std::ifstream ifs(fn);
+  if (!ifs) {
+    Status::os(Status::USER_ERROR) << "Failed to read sweep file: " << fn;
+    return false;
+  }
+  string line;
+  while (std::getline(ifs, line)) {
+    Config config;
+    if (!ParseLine(line, &config)) {
+      return false;
+    }
+    if (!config.line_.empty()) {
+      configs_.push_back(config);
+    }
+  }
+  if (configs_.empty()) {
+    Status::os(Status::USER_ERROR) << "No configuration in: " << fn;
+    return false;
+  }
+  return true;
+}
+
+bool Sweep::ParseLine(const string &line, Config *config) {
+  config->duration_ = -1;
+  std::istringstream is(line);
+  string kv;
+  while (is >> kv) {
+    if (kv[0] == '#') {
+      break;
+    }
+    size_t pos = kv.find('=');
+    char *end = nullptr;
+    uint64_t val = 0;
+    if (pos != string::npos) {
+      val = strtoull(kv.c_str() + pos + 1, &end, 0);
+    }
+    if (pos == string::npos || pos == 0 || end == kv.c_str() + pos + 1 ||
+	*end != '\0') {
+      Status::os(Status::USER_ERROR) << "Invalid sweep parameter: " << kv;
+      return false;
+    }
+    string name = kv.substr(0, pos);
+    if (name == "duration") {
+      config->duration_ = val;
+    } else {
+      config->params_.push_back(std::make_pair(name, val));
+    }
+    if (!config->line_.empty()) {
+      config->line_ += " ";
+    }
+    config->line_ += kv;
+  }
+  return true;
+}
+
+int Sweep::Fork(vm::VM *vm) {
+  // Worker threads don't survive fork().
+  vm->StopWorkers();
+  int num_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  if (num_jobs < 1) {
+    num_jobs = 1;
+  }
+  for (size_t i = 0; i < configs_.size(); ++i) {
+    while (num_running_ >= num_jobs) {
+      WaitOne();
+    }
+    Child c;
+    c.output_ = tmpfile();
+    c.ok_ = false;
+    if (c.output_ == nullptr) {
+      Status::os(Status::USER_ERROR) << "Failed to create a temp file";
+      break;
+    }
+    cout.flush();
+    c.pid_ = fork();
+    if (c.pid_ == 0) {
+      dup2(fileno(c.output_), STDOUT_FILENO);
+      dup2(fileno(c.output_), STDERR_FILENO);
+      ApplyConfig(configs_[i], vm);
+      return i;
+    }
+    if (c.pid_ < 0) {
+      fclose(c.output_);
+      Status::os(Status::USER_ERROR) << "Failed to fork";
+      break;
+    }
+    children_.push_back(c);
+    ++num_running_;
+  }
+  while (num_running_ > 0) {
+    WaitOne();
+  }
+  PrintReport();
+  return -1;
+}
+
+void Sweep::ExitChild(bool ok) {
+  ok &= !Status::CheckAllErrors(true);
+  ok &= (vm::NativeMethods::GetNumAssertionFailures() == 0);
+  cout.flush();
+  _exit(ok ? 0 : 1);
+}
+
+void Sweep::ApplyConfig(const Config &config, vm::VM *vm) {
+  if (config.duration_ >= 0) {
+    Env::SetDuration(config.duration_);
+  }
+  vm::Value *env = vm->kernel_object_->LookupValue(sym_lookup("Env"), false);
+  for (auto &p : config.params_) {
+    vm::ObjectUtil::SetIntMember(env->object_, p.first, p.second);
+  }
+}
+
+void Sweep::WaitOne() {
+  int status;
+  pid_t pid = wait(&status);
+  if (pid < 0) {
+    num_running_ = 0;
+    return;
+  }
+  for (Child &c : children_) {
+    if (c.pid_ == pid) {
+      c.ok_ = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+      --num_running_;
+      return;
+    }
+  }
+}
+
+void Sweep::PrintReport() {
+  int num_failures = 0;
+  for (size_t i = 0; i < children_.size(); ++i) {
+    Child &c = children_[i];
+    cout << "sweep[" << i << "]: " << configs_[i].line_ << "\n";
+    rewind(c.output_);
+    char buf[4096];
+    size_t s;
+    while ((s = fread(buf, 1, sizeof(buf), c.output_)) > 0) {
+      cout.write(buf, s);
+    }
+    cout << "sweep[" << i << "]: " << (c.ok_ ? "ok" : "failed") << "\n";
+    if (!c.ok_) {
+      ++num_failures;
+    }
+  }
+  cout << "sweep: " << children_.size() << " configurations, "
+       << num_failures << " failures\n";
+  if (num_failures > 0) {
+    Status::os(Status::USER_ERROR) << num_failures
+				   << " sweep configuration(s) failed";
+  }
+}
+
+}  // namespace fe
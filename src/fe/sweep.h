@@ -0,0 +1,55 @@
+// -*- C++ -*-
+#ifndef _fe_sweep_h_
+#define _fe_sweep_h_
+
+#include "fe/common.h"
+
+#include <stdio.h>
+#include <sys/types.h>
+
+namespace fe {
+
+// Runs the same files under many configurations (--sweep).
+// Each configuration runs in a child process forked from the VM after the
+// prelude is loaded, so the state is shared copy-on-write.
+class Sweep {
+public:
+  Sweep();
+  ~Sweep();
+
+  // Each line of the file is a configuration e.g. "duration=1000 width=8".
+  // duration overrides --duration and other names become int members of
+  // Env. Empty lines and lines starting with # are ignored.
+  bool ReadConfigs(const string &fn);
+  // Returns the index of the configuration in each child process.
+  // Returns -1 in this process after all of the children finished and
+  // the report is printed.
+  int Fork(vm::VM *vm);
+  // Called in a child process.
+  static void ExitChild(bool ok);
+
+private:
+  struct Config {
+    string line_;
+    long duration_;
+    vector<std::pair<string, uint64_t> > params_;
+  };
+  struct Child {
+    pid_t pid_;
+    FILE *output_;
+    bool ok_;
+  };
+
+  bool ParseLine(const string &line, Config *config);
+  void ApplyConfig(const Config &config, vm::VM *vm);
+  void WaitOne();
+  void PrintReport();
+
+  vector<Config> configs_;
+  vector<Child> children_;
+  int num_running_;
+};
+
+}  // namespace fe
+
+#endif  // _fe_sweep_h_
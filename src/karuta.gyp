@@ -65,6 +65,8 @@
         'base/util.h',
         'base/logging.cpp',
         'base/logging.h',
+        'compiler/bytecode_optimizer.cpp',
+        'compiler/bytecode_optimizer.h',
         'compiler/compiler.cpp',
         'compiler/compiler.h',
         'compiler/common.h',
@@ -96,6 +98,8 @@
         'fe/scanner.h',
         'fe/stmt.cpp',
         'fe/stmt.h',
+        'fe/sweep.cpp',
+        'fe/sweep.h',
         'fe/var_decl.cpp',
         'fe/var_decl.h',
         'karuta/annotation.cpp',
@@ -142,11 +146,15 @@
         'synth/thread_synth.h',
         'synth/tool.cpp',
         'synth/tool.h',
+        'vm/arena.cpp',
+        'vm/arena.h',
         'vm/array_wrapper.cpp',
         'vm/array_wrapper.h',
         'vm/channel_wrapper.cpp',
         'vm/channel_wrapper.h',
         'vm/common.h',
+        'vm/coroutine.cpp',
+        'vm/coroutine.h',
         'vm/decl_annotator.cpp',
         'vm/decl_annotator.h',
 	'vm/distance_wrapper.cpp',
@@ -159,6 +167,8 @@
         'vm/executor/executor.h',
         'vm/gc.cpp',
         'vm/gc.h',
+        'vm/inline_cache.cpp',
+        'vm/inline_cache.h',
         'vm/insn_annotator.cpp',
         'vm/insn_annotator.h',
         'vm/insn.cpp',
@@ -167,6 +177,8 @@
         'vm/int_array.h',
         'vm/mailbox_wrapper.cpp',
         'vm/mailbox_wrapper.h',
+        'vm/mem_image.cpp',
+        'vm/mem_image.h',
         'vm/method.cpp',
         'vm/method.h',
         'vm/method_frame.h',
@@ -186,6 +198,8 @@
         'vm/profile.h',
         'vm/register.cpp',
         'vm/register.h',
+        'vm/shape.cpp',
+        'vm/shape.h',
         'vm/enum_type_wrapper.cpp',
         'vm/enum_type_wrapper.h',
         'vm/string_wrapper.cpp',
@@ -196,13 +210,20 @@
         'vm/thread_queue.h',
         'vm/thread_wrapper.cpp',
         'vm/thread_wrapper.h',
+        'vm/timer_wheel.cpp',
+        'vm/timer_wheel.h',
         'vm/tls_wrapper.cpp',
         'vm/tls_wrapper.h',
         'vm/value.cpp',
         'vm/value.h',
         'vm/vm.cpp',
         'vm/vm.h',
+        'vm/worker_pool.cpp',
+        'vm/worker_pool.h',
       ],
+      'link_settings': {
+        'libraries': ['-lpthread'],
+      },
       'dependencies': [
         '../iroha/src/iroha.gyp:libiroha'
       ],
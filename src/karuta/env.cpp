@@ -20,6 +20,13 @@ long Env::duration_ = 1000000;
 bool Env::dot_output_;
 bool Env::with_self_shell_;
 bool Env::vcd_output_;
+bool Env::threaded_dispatch_ = true;
+bool Env::inline_cache_stats_ = false;
+bool Env::bytecode_optimization_ = false;
+int Env::num_workers_ = 0;
+string Env::sweep_file_;
+long Env::gc_heap_target_ = 64 * 1024 * 1024;
+bool Env::gc_stats_ = false;
 
 const string &Env::GetVersion() {
   static string v(VERSION);
@@ -172,3 +179,59 @@ void Env::EnableVcdOutput(bool en) {
 bool Env::GetVcdOutput() {
   return vcd_output_;
 }
+
+void Env::SetThreadedDispatch(bool threaded) {
+  threaded_dispatch_ = threaded;
+}
+
+bool Env::GetThreadedDispatch() {
+  return threaded_dispatch_;
+}
+
+void Env::EnableInlineCacheStats(bool en) {
+  inline_cache_stats_ = en;
+}
+
+bool Env::GetInlineCacheStats() {
+  return inline_cache_stats_;
+}
+
+void Env::SetByteCodeOptimization(bool en) {
+  bytecode_optimization_ = en;
+}
+
+bool Env::GetByteCodeOptimization() {
+  return bytecode_optimization_;
+}
+
+void Env::SetNumWorkers(int num_workers) {
+  num_workers_ = num_workers;
+}
+
+int Env::GetNumWorkers() {
+  return num_workers_;
+}
+
+void Env::SetSweepFile(const string &fn) {
+  sweep_file_ = fn;
+}
+
+const string &Env::GetSweepFile() {
+  return sweep_file_;
+}
+
+void Env::SetGCHeapTarget(long bytes) {
+  gc_heap_target_ = bytes;
+}
+
+long Env::GetGCHeapTarget() {
+  return gc_heap_target_;
+}
+
+void Env::EnableGCStats(bool en) {
+  gc_stats_ = en;
+}
+
+bool Env::GetGCStats() {
+  return gc_stats_;
+}
@@ -38,6 +38,20 @@ public:
   static void SetWithSelfShell(bool with_self_shell);
   static void EnableVcdOutput(bool en);
   static bool GetVcdOutput();
+  static void SetThreadedDispatch(bool threaded);
+  static bool GetThreadedDispatch();
+  static void EnableInlineCacheStats(bool en);
+  static bool GetInlineCacheStats();
+  static void SetByteCodeOptimization(bool en);
+  static bool GetByteCodeOptimization();
+  static void SetNumWorkers(int num_workers);
+  static int GetNumWorkers();
+  static void SetSweepFile(const string &fn);
+  static const string &GetSweepFile();
+  static void SetGCHeapTarget(long bytes);
+  static long GetGCHeapTarget();
+  static void EnableGCStats(bool en);
+  static bool GetGCStats();
 
 private:
   static const char *karuta_dir_;
@@ -53,6 +67,13 @@ private:
   static bool dot_output_;
   static bool with_self_shell_;
   static bool vcd_output_;
+  static bool threaded_dispatch_;
+  static bool inline_cache_stats_;
+  static bool bytecode_optimization_;
+  static int num_workers_;
+  static string sweep_file_;
+  static long gc_heap_target_;
+  static bool gc_stats_;
 };
 
 #endif  // _karuta_env_h_
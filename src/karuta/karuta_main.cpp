@@ -31,20 +31,27 @@ void Main::PrintUsage() {
        << "   -d[spb] scanner,parser,byte code compiler\n"
        << "   -l\n"
        << "   -l=[modules]\n"
+       << "   --bytecode_opt\n"
        << "   --compile\n"
+       << "   --dispatch [switch|threaded]\n"
        << "   --duration\n"
        << "   --dot\n"
+       << "   --gc_heap_target [MB]\n"
+       << "   --gc_stats\n"
+       << "   --ic_stats\n"
        << "   --iroha_binary [iroha]\n"
        << "   --module_prefix [mod]\n"
        << "   --output_marker [marker]\n"
        << "   --print_exit_status\n"
        << "   --root [path]\n"
        << "   --run\n"
+       << "   --sweep [file]\n"
        << "   --timeout [ms]\n"
        << "   --vanilla\n"
        << "   --vcd\n"
        << "   --version\n"
-       << "   --with_shell\n";
+       << "   --with_shell\n"
+       << "   --workers [n]\n";
   exit(0);
 }
 
@@ -94,10 +101,13 @@ void Main::InstallTimeout() {
 }
 
 void Main::ParseArgs(int argc, char **argv, ArgParser *parser) {
+  parser->RegisterBoolFlag("bytecode_opt", nullptr);
   parser->RegisterBoolFlag("compile", nullptr);
   parser->RegisterBoolFlag("dot", nullptr);
+  parser->RegisterBoolFlag("gc_stats", nullptr);
   parser->RegisterBoolFlag("h", "help");
   parser->RegisterBoolFlag("help", nullptr);
+  parser->RegisterBoolFlag("ic_stats", nullptr);
   parser->RegisterBoolFlag("iroha", nullptr);
   parser->RegisterBoolFlag("print_exit_status", nullptr);
   parser->RegisterBoolFlag("run", nullptr);
@@ -105,12 +115,16 @@ void Main::ParseArgs(int argc, char **argv, ArgParser *parser) {
   parser->RegisterBoolFlag("vanilla", nullptr);
   parser->RegisterBoolFlag("vcd", nullptr);
   parser->RegisterBoolFlag("version", "help");
+  parser->RegisterValueFlag("dispatch", nullptr);
   parser->RegisterValueFlag("duration", nullptr);
+  parser->RegisterValueFlag("gc_heap_target", nullptr);
   parser->RegisterValueFlag("iroha_binary", nullptr);
   parser->RegisterValueFlag("module_prefix", nullptr);
   parser->RegisterValueFlag("output_marker", nullptr);
   parser->RegisterValueFlag("root", nullptr);
+  parser->RegisterValueFlag("sweep", nullptr);
   parser->RegisterValueFlag("timeout", nullptr);
+  parser->RegisterValueFlag("workers", nullptr);
   if (!parser->Parse(argc, argv)) {
     exit(0);
   }
@@ -159,9 +173,35 @@ int Main::main(int argc, char **argv) {
     long d = iroha::Util::AtoULL(arg);
     Env::SetDuration(d);
   }
+  if (args.GetFlagValue("workers", &arg)) {
+    Env::SetNumWorkers(iroha::Util::AtoULL(arg));
+  }
+  if (args.GetFlagValue("gc_heap_target", &arg)) {
+    Env::SetGCHeapTarget(iroha::Util::AtoULL(arg) * 1024 * 1024);
+  }
+  if (args.GetFlagValue("sweep", &arg)) {
+    Env::SetSweepFile(arg);
+  }
+  if (args.GetFlagValue("dispatch", &arg)) {
+    if (arg != "switch" && arg != "threaded") {
+      Status::os(Status::USER_ERROR) << "Unknown dispatch method:" << arg;
+      MessageFlush::Get(Status::USER_ERROR);
+      PrintUsage();
+    }
+    Env::SetThreadedDispatch(arg == "threaded");
+  }
+  if (args.GetBoolFlag("bytecode_opt", false)) {
+    Env::SetByteCodeOptimization(true);
+  }
   if (args.GetBoolFlag("dot", false)) {
     Env::EnableDotOutput(true);
   }
+  if (args.GetBoolFlag("gc_stats", false)) {
+    Env::EnableGCStats(true);
+  }
+  if (args.GetBoolFlag("ic_stats", false)) {
+    Env::EnableInlineCacheStats(true);
+  }
   if (args.GetBoolFlag("with_shell", false)) {
     Env::SetWithSelfShell(true);
   }
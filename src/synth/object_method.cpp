@@ -61,6 +61,13 @@ void ObjectMethod::Synth() {
     iinsn = SynthChannelAccess(obj, false);
   } else if (name == kChannelWrite || name == kChannelNoWaitWrite) {
     iinsn = SynthChannelAccess(obj, true);
+  } else if (name == kChannelWriteBurst || name == kChannelReadBurst) {
+    Status::os(Status::USER_ERROR)
+      << "Channel burst methods (writeBurst and readBurst) can't be synthesized. Use a loop.";
+  } else if (name == kArrayFill || name == kArrayCopyFrom ||
+	     name == kArraySlice || name == kArrayEquals) {
+    Status::os(Status::USER_ERROR)
+      << "Bulk array methods (fill, copyFrom, slice and equals) can't be synthesized. Use a loop.";
   } else {
     CHECK(false) << name;
   }
@@ -12,6 +12,8 @@ const char kAxiStore[] = "store";
 const char kChannelRead[] = "channel_read";
 const char kChannelWrite[] = "channel_write";
 const char kChannelNoWaitWrite[] = "channel_no_wait_write";
+const char kChannelWriteBurst[] = "channel_write_burst";
+const char kChannelReadBurst[] = "channel_read_burst";
 const char kGetTickCount[] = "get_tick_count";
 const char kSlaveWait[] = "wait";
 const char kSramRead[] = "sram_read";
@@ -21,6 +23,10 @@ const char kMailboxPut[] = "mailbox_put";
 const char kMailboxWait[] = "mailbox_wait";
 const char kMailboxNotify[] = "mailbox_notify";
 const char kMailboxWidth[] = "mailbox_width";
+const char kArrayFill[] = "array_fill";
+const char kArrayCopyFrom[] = "array_copy_from";
+const char kArraySlice[] = "array_slice";
+const char kArrayEquals[] = "array_equals";
 
 }  // namespace synth
 
@@ -0,0 +1,168 @@
+#include "vm/arena.h"
+
+#include <new>
+#include <stdlib.h>
+
+namespace vm {
+
+static const size_t kSlabAllocatorSlabSize = 64 * 1024;
+// Size classes for ObjectSpecificData.
+static const size_t kDataSizeUnit = 16;
+static const int kNumDataSizeClasses = 16;
+
+SlabAllocator::SlabAllocator(size_t block_size)
+  : block_size_(block_size), free_list_(nullptr) {
+  if (block_size_ < sizeof(FreeBlock)) {
+    block_size_ = sizeof(FreeBlock);
+  }
+}
+
+SlabAllocator::~SlabAllocator() {
+  for (char *slab : slabs_) {
+    free(slab);
+  }
+}
+
+void *SlabAllocator::Allocate() {
+  if (free_list_ == nullptr) {
+    AddSlab();
+  }
+  FreeBlock *b = free_list_;
+  free_list_ = b->next_;
+  return b;
+}
+
+void SlabAllocator::Free(void *p) {
+  FreeBlock *b = (FreeBlock *)p;
+  b->next_ = free_list_;
+  free_list_ = b;
+}
+
+void SlabAllocator::AddSlab() {
+  char *slab = (char *)malloc(kSlabAllocatorSlabSize);
+  CHECK(slab != nullptr);
+  slabs_.push_back(slab);
+  size_t n = kSlabAllocatorSlabSize / block_size_;
+  // Chains in the reverse order, so that the blocks are used from the top.
+  for (size_t i = n; i > 0; --i) {
+    Free(slab + (i - 1) * block_size_);
+  }
+}
+
+static SlabAllocator *GetDataAllocator(size_t size) {
+  static SlabAllocator *allocators[kNumDataSizeClasses];
+  int c = (size + kDataSizeUnit - 1) / kDataSizeUnit - 1;
+  if (allocators[c] == nullptr) {
+    // Never freed, since data can be deleted at the exit.
+    allocators[c] = new SlabAllocator((c + 1) * kDataSizeUnit);
+  }
+  return allocators[c];
+}
+
+void *SlabAllocator::AllocateData(size_t size) {
+  if (size > kDataSizeUnit * kNumDataSizeClasses) {
+    return ::operator new(size);
+  }
+  return GetDataAllocator(size)->Allocate();
+}
+
+void SlabAllocator::FreeData(void *p, size_t size) {
+  if (size > kDataSizeUnit * kNumDataSizeClasses) {
+    ::operator delete(p);
+    return;
+  }
+  GetDataAllocator(size)->Free(p);
+}
+
+ObjectArena::ObjectArena() : free_list_(nullptr) {
+}
+
+ObjectArena::~ObjectArena() {
+  ForEach([this](Object *obj) { Delete(obj); });
+  for (Slab *slab : slabs_) {
+    free(slab);
+  }
+}
+
+int ObjectArena::NumObjectsPerSlab() {
+  int n = (kSlabSize - sizeof(Slab)) / sizeof(Object);
+  if (n > kBitmapWords * 64) {
+    n = kBitmapWords * 64;
+  }
+  return n;
+}
+
+ObjectArena::Slab *ObjectArena::SlabOf(Object *obj) {
+  return (Slab *)((uintptr_t)obj & ~(uintptr_t)(kSlabSize - 1));
+}
+
+Object *ObjectArena::New(VM *vm) {
+  if (free_list_ == nullptr) {
+    AddSlab();
+  }
+  FreeSlot *s = free_list_;
+  free_list_ = s->next_;
+  Object *obj = new (s) Object(vm);
+  Slab *slab = SlabOf(obj);
+  int i = ((char *)obj - slab->Objects()) / sizeof(Object);
+  slab->live_[i / 64] |= (1ULL << (i % 64));
+  return obj;
+}
+
+void ObjectArena::Delete(Object *obj) {
+  Slab *slab = SlabOf(obj);
+  int i = ((char *)obj - slab->Objects()) / sizeof(Object);
+  slab->live_[i / 64] &= ~(1ULL << (i % 64));
+  obj->~Object();
+  FreeSlot *s = (FreeSlot *)obj;
+  s->next_ = free_list_;
+  free_list_ = s;
+}
+
+void ObjectArena::AddSlab() {
+  void *p = nullptr;
+  int r = posix_memalign(&p, kSlabSize, kSlabSize);
+  CHECK(r == 0);
+  Slab *slab = (Slab *)p;
+  for (int w = 0; w < kBitmapWords; ++w) {
+    slab->live_[w] = 0;
+  }
+  slabs_.push_back(slab);
+  char *objs = slab->Objects();
+  for (int i = NumObjectsPerSlab(); i > 0; --i) {
+    FreeSlot *s = (FreeSlot *)(objs + (i - 1) * sizeof(Object));
+    s->next_ = free_list_;
+    free_list_ = s;
+  }
+}
+
+void ObjectArena::ReleaseEmptySlabs() {
+  const int n = NumObjectsPerSlab();
+  vector<Slab *> slabs;
+  FreeSlot **tail = &free_list_;
+  for (Slab *slab : slabs_) {
+    bool empty = true;
+    for (int w = 0; w < kBitmapWords; ++w) {
+      if (slab->live_[w] != 0) {
+	empty = false;
+      }
+    }
+    if (empty) {
+      free(slab);
+      continue;
+    }
+    slabs.push_back(slab);
+    char *objs = slab->Objects();
+    for (int i = 0; i < n; ++i) {
+      if ((slab->live_[i / 64] & (1ULL << (i % 64))) == 0) {
+	FreeSlot *s = (FreeSlot *)(objs + i * sizeof(Object));
+	*tail = s;
+	tail = &s->next_;
+      }
+    }
+  }
+  *tail = nullptr;
+  slabs_.swap(slabs);
+}
+
+}  // namespace vm
@@ -0,0 +1,91 @@
+// -*- C++ -*-
+#ifndef _vm_arena_h_
+#define _vm_arena_h_
+
+#include "vm/common.h"
+#include "vm/object.h"
+
+namespace vm {
+
+// Allocates fixed size blocks from large slabs. Freed blocks are chained
+// and reused. Not thread safe (callers hold the VM lock in parallel mode).
+class SlabAllocator {
+public:
+  explicit SlabAllocator(size_t block_size);
+  ~SlabAllocator();
+
+  void *Allocate();
+  void Free(void *p);
+
+  // Used for ObjectSpecificData. Sizes larger than the size classes are
+  // allocated by ::operator new.
+  static void *AllocateData(size_t size);
+  static void FreeData(void *p, size_t size);
+
+private:
+  struct FreeBlock {
+    FreeBlock *next_;
+  };
+
+  void AddSlab();
+
+  size_t block_size_;
+  FreeBlock *free_list_;
+  vector<char *> slabs_;
+};
+
+// Allocates Objects from aligned slabs. Each slab has a bitmap of live
+// objects, so the GC can sweep every object without a separate list.
+class ObjectArena {
+public:
+  ObjectArena();
+  // Deletes the live objects.
+  ~ObjectArena();
+
+  Object *New(VM *vm);
+  void Delete(Object *obj);
+  // Calls fn for each live object. fn may Delete() the object.
+  template<class F>
+  void ForEach(F fn);
+  // Releases slabs without live objects and rebuilds the free list in the
+  // address order, so that new objects are allocated close together.
+  void ReleaseEmptySlabs();
+
+private:
+  static const size_t kSlabSize = 64 * 1024;
+  static const int kBitmapWords = 16;
+  struct Slab {
+    uint64_t live_[kBitmapWords];
+    char *Objects() { return (char *)this + sizeof(Slab); }
+  };
+  struct FreeSlot {
+    FreeSlot *next_;
+  };
+
+  static int NumObjectsPerSlab();
+  static Slab *SlabOf(Object *obj);
+  void AddSlab();
+
+  FreeSlot *free_list_;
+  vector<Slab *> slabs_;
+};
+
+template<class F>
+void ObjectArena::ForEach(F fn) {
+  const int n = NumObjectsPerSlab();
+  for (Slab *slab : slabs_) {
+    char *objs = slab->Objects();
+    for (int w = 0; w < kBitmapWords && w * 64 < n; ++w) {
+      uint64_t bits = slab->live_[w];
+      while (bits) {
+	int b = __builtin_ctzll(bits);
+	bits &= bits - 1;
+	fn((Object *)(objs + (w * 64 + b) * sizeof(Object)));
+      }
+    }
+  }
+}
+
+}  // namespace vm
+
+#endif  // _vm_arena_h_
@@ -2,10 +2,12 @@
 
 #include <sstream>
 
+#include "base/status.h"
 #include "base/util.h"
 #include "karuta/annotation.h"
 #include "numeric/numeric_op.h"  // from iroha
 #include "synth/object_method_names.h"
+#include "vm/gc.h"
 #include "vm/int_array.h"
 #include "vm/native_objects.h"
 #include "vm/method.h"
@@ -61,6 +63,12 @@ public:
   ThreadQueue waiters_;
   vector<uint64_t> shape_;
 
+  virtual void Scan(GC *gc) {
+    for (Object *obj : objs_) {
+      gc->Mark(obj);
+    }
+  }
+
   virtual const char *ObjectTypeKey() {
     if (int_array_) {
       return kIntArrayKey;
@@ -131,6 +139,7 @@ Object *ArrayWrapper::Get(Object *obj, int nth) {
 void ArrayWrapper::Set(Object *obj, int nth, Object *elem) {
   ArrayWrapperData *data = (ArrayWrapperData *)obj->object_specific_.get();
   CHECK(nth >= 0 && nth < (int)data->objs_.size());
+  obj->WriteBarrier();
   data->objs_[nth] = elem;
 }
 
@@ -150,7 +159,7 @@ int ArrayWrapper::GetDataWidth(Object *obj) {
   return a->GetDataWidth().GetWidth();
 }
 
-void ArrayWrapper::Read(Thread *thr, Object *obj, const vector<Value> &args) {
+void ArrayWrapper::Read(Thread *thr, Object *obj, const ValueSpan &args) {
   CHECK(args.size() > 0) << "read requires an address";
   uint64_t addr = args[0].num_.GetValue0();
   ArrayWrapperData *data = (ArrayWrapperData *)obj->object_specific_.get();
@@ -162,7 +171,7 @@ void ArrayWrapper::Read(Thread *thr, Object *obj, const vector<Value> &args) {
   thr->SetReturnValueFromNativeMethod(value);
 }
 
-void ArrayWrapper::Write(Thread *thr, Object *obj, const vector<Value> &args) {
+void ArrayWrapper::Write(Thread *thr, Object *obj, const ValueSpan &args) {
   CHECK(args.size() > 1) << "write requires an address and data";
   uint64_t addr = args[0].num_.GetValue0();
   uint64_t data = args[1].num_.GetValue0();
@@ -174,14 +183,14 @@ void ArrayWrapper::Write(Thread *thr, Object *obj, const vector<Value> &args) {
 }
 
 void ArrayWrapper::AxiLoad(Thread *thr, Object *obj,
-			   const vector<Value> &args) {
+			   const ValueSpan &args) {
   CHECK(args.size() > 0) << "load requires an address";
   MemBurstAccess(thr, obj, args, true);
   MayNotifyWaiters(obj);
 }
 
 void ArrayWrapper::AxiStore(Thread *thr, Object *obj,
-			    const vector<Value> &args) {
+			    const ValueSpan &args) {
   CHECK(args.size() > 0) << "store requires an address";
   MemBurstAccess(thr, obj, args, false);
   MayNotifyWaiters(obj);
@@ -193,22 +202,18 @@ void ArrayWrapper::MayNotifyWaiters(Object *obj) {
 }
 
 void ArrayWrapper::WaitAccess(Thread *thr, Object *obj,
-			      const vector<Value> &args) {
+			      const ValueSpan &args) {
   ArrayWrapperData *ad = (ArrayWrapperData *)obj->object_specific_.get();
-  if (ad->waiters_.ClearIfNotified(thr)) {
-    return;
-  }
-  ad->waiters_.AddThread(thr);
-  thr->Suspend();
+  ad->waiters_.Wait(thr);
 }
 
 void ArrayWrapper::NotifyAccess(Thread *thr, Object *obj,
-				const vector<Value> &args) {
+				const ValueSpan &args) {
   MayNotifyWaiters(obj);
 }
 
 void ArrayWrapper::MemBurstAccess(Thread *thr, Object *obj,
-				  const vector<Value> &args,
+				  const ValueSpan &args,
 				  bool is_load) {
   IntArray *mem = thr->GetVM()->GetDefaultMemory();
   ArrayWrapperData *data = (ArrayWrapperData *)obj->object_specific_.get();
@@ -227,6 +232,17 @@ void ArrayWrapper::MemBurstAccess(Thread *thr, Object *obj,
   if (args.size() >= 3) {
     array_addr = args[2].num_.GetValue0();
   }
+  if (mem->GetDataWidth().GetWidth() == arr->GetDataWidth().GetWidth() &&
+      mem_addr_step > 0 && mem_addr % mem_addr_step == 0) {
+    // Values are copied as they are.
+    uint64_t mem_index = mem_addr / mem_addr_step;
+    if (is_load) {
+      arr->CopyFrom(array_addr, mem, mem_index, count);
+    } else {
+      mem->CopyFrom(mem_index, arr, array_addr, count);
+    }
+    return;
+  }
   // Do the copy.
   for (int i = 0; i < count; ++i) {
     if (is_load) {
@@ -243,18 +259,97 @@ void ArrayWrapper::MemBurstAccess(Thread *thr, Object *obj,
   }
 }
 
+void ArrayWrapper::Fill(Thread *thr, Object *obj, const ValueSpan &args) {
+  CHECK(args.size() > 0) << "fill requires a value";
+  IntArray *arr = GetIntArray(obj);
+  uint64_t start = 0;
+  if (args.size() >= 2) {
+    start = args[1].num_.GetValue0();
+  }
+  uint64_t count = arr->GetLength();
+  if (args.size() >= 3) {
+    count = args[2].num_.GetValue0();
+  }
+  arr->Fill(start, count, args[0].num_type_, args[0].num_);
+  MayNotifyWaiters(obj);
+}
+
+void ArrayWrapper::CopyFrom(Thread *thr, Object *obj,
+			    const ValueSpan &args) {
+  CHECK(args.size() > 0 && args[0].IsObjectType() &&
+	IsIntArray(args[0].object_)) << "copyFrom requires an int array";
+  IntArray *arr = GetIntArray(obj);
+  IntArray *src = GetIntArray(args[0].object_);
+  uint64_t start = 0;
+  if (args.size() >= 2) {
+    start = args[1].num_.GetValue0();
+  }
+  uint64_t src_start = 0;
+  if (args.size() >= 3) {
+    src_start = args[2].num_.GetValue0();
+  }
+  uint64_t count = arr->GetLength();
+  if (count == 0) {
+    count = src->GetLength();
+  }
+  if (args.size() >= 4) {
+    count = args[3].num_.GetValue0();
+  }
+  arr->CopyFrom(start, src, src_start, count);
+  MayNotifyWaiters(obj);
+}
+
+void ArrayWrapper::Slice(Thread *thr, Object *obj, const ValueSpan &args) {
+  CHECK(args.size() > 1) << "slice requires a start and a count";
+  IntArray *arr = GetIntArray(obj);
+  uint64_t start = args[0].num_.GetValue0();
+  uint64_t count = args[1].num_.GetValue0();
+  CHECK(count > 0) << "slice requires a positive count";
+  vector<uint64_t> shape;
+  shape.push_back(count);
+  Object *slice_obj =
+    NewIntArrayWrapper(thr->GetVM(), shape, arr->GetDataWidth(), nullptr);
+  GetIntArray(slice_obj)->CopyFrom(0, arr, start, count);
+  Value value;
+  value.type_ = Value::OBJECT;
+  value.object_ = slice_obj;
+  thr->SetReturnValueFromNativeMethod(value);
+}
+
+void ArrayWrapper::Equals(Thread *thr, Object *obj, const ValueSpan &args) {
+  CHECK(args.size() > 0 && args[0].IsObjectType()) <<
+    "equals requires an array";
+  bool eq = false;
+  if (IsIntArray(args[0].object_)) {
+    IntArray *arr = GetIntArray(obj);
+    IntArray *other = GetIntArray(args[0].object_);
+    // Unbounded arrays can't be compared element by element.
+    if (arr->GetLength() == 0 || other->GetLength() == 0) {
+      Status::os(Status::USER_ERROR) << "equals() of an unbounded array";
+      thr->UserError();
+      return;
+    }
+    eq = arr->Equals(other);
+  }
+  Value value;
+  value.type_ = Value::ENUM_ITEM;
+  value.enum_val_.enum_type = thr->GetVM()->bool_type_;
+  value.enum_val_.val = eq ? 1 : 0;
+  thr->SetReturnValueFromNativeMethod(value);
+}
+
 void ArrayWrapper::SaveImage(Thread *thr, Object *obj,
-			     const vector<Value> &args) {
+			     const ValueSpan &args) {
   ImageIO(true, thr, obj, args);
 }
 
 void ArrayWrapper::LoadImage(Thread *thr, Object *obj,
-			     const vector<Value> &args) {
+			     const ValueSpan &args) {
   ImageIO(false, thr, obj, args);
 }
 
 void ArrayWrapper::ImageIO(bool save, Thread *thr, Object *obj,
-			   const vector<Value> &args) {
+			   const ValueSpan &args) {
   CHECK(args.size() > 0) << "save/load image requires a file name";
   const Value& arg = args[0];
   CHECK(StringWrapper::IsString(arg.object_));
@@ -266,7 +361,19 @@ void ArrayWrapper::ImageIO(bool save, Thread *thr, Object *obj,
     CHECK(StringWrapper::IsString(fmt.object_));
     format = StringWrapper::String(fmt.object_);
   }
-  arr->ImageIO(StringWrapper::String(arg.object_), format, save);
+  const string &fn = StringWrapper::String(arg.object_);
+  if (!save && (format.empty() || format == "shared")) {
+    IntArray *mapped = IntArray::MapImage(arr, fn, !format.empty());
+    if (mapped != nullptr) {
+      data->int_array_.reset(mapped);
+      return;
+    }
+  }
+  if (!arr->ImageIO(fn, format, save)) {
+    Status::os(Status::USER_ERROR) << "Failed to " << (save ? "save" : "load")
+				   << " an image: " << fn;
+    thr->UserError();
+  }
 }
 
 void ArrayWrapper::InstallMethods(VM *vm, Object *obj) {
@@ -289,6 +396,21 @@ void ArrayWrapper::InstallMethods(VM *vm, Object *obj) {
 				     &ArrayWrapper::SaveImage, rets);
   NativeObjects::InstallNativeMethod(vm, obj, "loadImage",
 				     &ArrayWrapper::LoadImage, rets);
+  m = NativeObjects::InstallNativeMethod(vm, obj, "fill",
+					 &ArrayWrapper::Fill, rets);
+  m->SetSynthName(synth::kArrayFill);
+  m = NativeObjects::InstallNativeMethod(vm, obj, "copyFrom",
+					 &ArrayWrapper::CopyFrom, rets);
+  m->SetSynthName(synth::kArrayCopyFrom);
+  rets.push_back(NativeObjects::ObjectType());
+  m = NativeObjects::InstallNativeMethod(vm, obj, "slice",
+					 &ArrayWrapper::Slice, rets);
+  m->SetSynthName(synth::kArraySlice);
+  rets.clear();
+  rets.push_back(NativeObjects::BoolType(vm));
+  m = NativeObjects::InstallNativeMethod(vm, obj, "equals",
+					 &ArrayWrapper::Equals, rets);
+  m->SetSynthName(synth::kArrayEquals);
 }
 
 void ArrayWrapper::InstallSramIfMethods(VM *vm ,Object *obj) {
@@ -26,17 +26,21 @@ public:
   static void InstallSramIfMethods(VM *vm ,Object *obj);
 
 private:
-  static void AxiLoad(Thread *thr, Object *obj, const vector<Value> &args);
-  static void AxiStore(Thread *thr, Object *obj, const vector<Value> &args);
-  static void WaitAccess(Thread *thr, Object *obj, const vector<Value> &args);
-  static void NotifyAccess(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Read(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Write(Thread *thr, Object *obj, const vector<Value> &args);
+  static void AxiLoad(Thread *thr, Object *obj, const ValueSpan &args);
+  static void AxiStore(Thread *thr, Object *obj, const ValueSpan &args);
+  static void WaitAccess(Thread *thr, Object *obj, const ValueSpan &args);
+  static void NotifyAccess(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Read(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Write(Thread *thr, Object *obj, const ValueSpan &args);
   static void MemBurstAccess(Thread *thr, Object *obj,
-			     const vector<Value> &args, bool is_load);
-  static void SaveImage(Thread *thr, Object *obj, const vector<Value> &args);
-  static void LoadImage(Thread *thr, Object *obj, const vector<Value> &args);
-  static void ImageIO(bool save, Thread *thr, Object *obj, const vector<Value> &args);
+			     const ValueSpan &args, bool is_load);
+  static void Fill(Thread *thr, Object *obj, const ValueSpan &args);
+  static void CopyFrom(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Slice(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Equals(Thread *thr, Object *obj, const ValueSpan &args);
+  static void SaveImage(Thread *thr, Object *obj, const ValueSpan &args);
+  static void LoadImage(Thread *thr, Object *obj, const ValueSpan &args);
+  static void ImageIO(bool save, Thread *thr, Object *obj, const ValueSpan &args);
   static void InstallMethods(VM *vm ,Object *obj);
   static void MayNotifyWaiters(Object *obj);
 };
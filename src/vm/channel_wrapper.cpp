@@ -4,6 +4,8 @@
 #include "karuta/annotation.h"
 #include "numeric/numeric_op.h"  // from iroha
 #include "synth/object_method_names.h"
+#include "vm/array_wrapper.h"
+#include "vm/int_array.h"
 #include "vm/object.h"
 #include "vm/thread.h"
 #include "vm/thread_queue.h"
@@ -12,10 +14,6 @@
 #include "vm/native_objects.h"
 #include "vm/vm.h"
 
-#include <list>
-
-using std::list;
-
 namespace vm {
 
 static const char *kChannelObjectKey = "channel";
@@ -29,6 +27,9 @@ public:
     } else {
       depth_ = an_->GetDepth();
     }
+    values_.resize((depth_ > 0) ? depth_ : 1);
+    head_ = 0;
+    num_values_ = 0;
   };
   virtual ~ChannelData() {};
 
@@ -36,11 +37,40 @@ public:
     return kChannelObjectKey;
   }
 
+  bool IsEmpty() const {
+    return num_values_ == 0;
+  }
+  bool IsFull() const {
+    return num_values_ == values_.size();
+  }
+  void Push(const iroha::NumericValue &v) {
+    int tail = head_ + num_values_;
+    if (tail >= values_.size()) {
+      tail -= values_.size();
+    }
+    values_[tail] = v;
+    ++num_values_;
+  }
+  const iroha::NumericValue &Pop() {
+    const iroha::NumericValue &v = values_[head_];
+    ++head_;
+    if (head_ == values_.size()) {
+      head_ = 0;
+    }
+    --num_values_;
+    return v;
+  }
+
   int width_;
   string name_;
-  list<iroha::NumericValue> values_;
   int depth_;
+  // Ring buffer of depth_ values from head_.
+  vector<iroha::NumericValue> values_;
+  int head_;
+  int num_values_;
 
+  // Guards the values and the waiters. Taken after the VM lock, if both.
+  std::mutex mu_;
   ThreadQueue read_waiters_;
   ThreadQueue write_waiters_;
   Annotation *an_;
@@ -49,18 +79,31 @@ public:
 Object *ChannelWrapper::NewChannel(VM *vm, int width, sym_t name,
 				   Annotation *an) {
   Object *pipe = vm->root_object_->Clone();
+  // Wider values may be allocated by iroha, which is not thread safe.
+  bool thread_safe = (width <= 128);
   vector<RegisterType> rets;
   Method *m = NativeObjects::InstallNativeMethod(vm, pipe, "write",
 						 &ChannelWrapper::WriteMethod,
 						 rets);
   m->SetSynthName(synth::kChannelWrite);
+  m->SetIsThreadSafe(thread_safe);
   m = NativeObjects::InstallNativeMethod(vm, pipe, "writeFast",
 					 &ChannelWrapper::WriteMethod, rets);
   m->SetSynthName(synth::kChannelNoWaitWrite);
+  m->SetIsThreadSafe(thread_safe);
+  m = NativeObjects::InstallNativeMethod(vm, pipe, "writeBurst",
+					 &ChannelWrapper::WriteBurstMethod,
+					 rets);
+  m->SetSynthName(synth::kChannelWriteBurst);
+  m = NativeObjects::InstallNativeMethod(vm, pipe, "readBurst",
+					 &ChannelWrapper::ReadBurstMethod,
+					 rets);
+  m->SetSynthName(synth::kChannelReadBurst);
   rets.push_back(NativeObjects::IntType(width));
   m = NativeObjects::InstallNativeMethod(vm, pipe, "read",
 					 &ChannelWrapper::ReadMethod, rets);
   m->SetSynthName(synth::kChannelRead);
+  m->SetIsThreadSafe(thread_safe);
 
   pipe->object_specific_.reset(new ChannelData(width, name, an));
 
@@ -90,35 +133,34 @@ int ChannelWrapper::ChannelDepth(Object *obj) {
 }
 
 void ChannelWrapper::ReadMethod(Thread *thr, Object *obj,
-				const vector<Value> &args) {
+				const ValueSpan &args) {
   Value value;
-  if (!ReadValue(thr, obj, &value)) {
-    return;
-  }
+  ReadValue(thr, obj, &value);
 
   NativeMethods::SetReturnValue(thr, value);
 }
 
-bool ChannelWrapper::ReadValue(Thread *thr, Object *obj, Value *value) {
+void ChannelWrapper::ReadValue(Thread *thr, Object *obj, Value *value) {
   ChannelData *pipe_data = (ChannelData *)obj->object_specific_.get();
-  if (pipe_data->values_.size() == 0) {
-    BlockOnRead(thr, obj);
-    return false;
+  std::unique_lock<std::mutex> lock(pipe_data->mu_);
+  while (pipe_data->IsEmpty()) {
+    BlockOnRead(thr, obj, &lock);
   }
 
   value->type_ = Value::NUM;
-  iroha::NumericValue v = *(pipe_data->values_.begin());
-  value->num_ = v;
+  value->num_ = pipe_data->Pop();
   value->num_type_ = iroha::NumericWidth(false, pipe_data->width_);
-  pipe_data->values_.pop_front();
-  // Wake writers.
-  pipe_data->write_waiters_.ResumeAll();
-  return true;
+  // Wake a writer. A woken thread checks the state again and waits again
+  // if another thread took the room first, so waking one per value is
+  // enough.
+  pipe_data->write_waiters_.ResumeOne();
 }
 
 void ChannelWrapper::WriteMethod(Thread *thr, Object *obj,
-				 const vector<Value> &args) {
+				 const ValueSpan &args) {
   if (args.size() != 1 || args[0].type_ != Value::NUM) {
+    // Called without the VM lock.
+    std::lock_guard<VMLock> lock(thr->GetVM()->GetLock());
     Status::os(Status::USER_ERROR) << "Channel.write takes one value argument";
     thr->UserError();
     return;
@@ -128,24 +170,85 @@ void ChannelWrapper::WriteMethod(Thread *thr, Object *obj,
 
 void ChannelWrapper::WriteValue(const Value &value, Thread *thr, Object *obj) {
   ChannelData *pipe_data = (ChannelData *)obj->object_specific_.get();
-  if (pipe_data->values_.size() == pipe_data->depth_) {
-    BlockOnWrite(thr, obj);
+  std::unique_lock<std::mutex> lock(pipe_data->mu_);
+  while (pipe_data->IsFull()) {
+    BlockOnWrite(thr, obj, &lock);
+  }
+  pipe_data->Push(value.num_);
+  // Wake a reader.
+  pipe_data->read_waiters_.ResumeOne();
+}
+
+IntArray *ChannelWrapper::GetBurstArray(Thread *thr, const char *name,
+					const ValueSpan &args,
+					uint64_t *count) {
+  if (args.size() != 2 || !args[0].IsObjectType() ||
+      !ArrayWrapper::IsIntArray(args[0].object_) ||
+      args[1].type_ != Value::NUM) {
+    Status::os(Status::USER_ERROR) << "Channel." << name
+				   << " takes an int array and a count";
+    thr->UserError();
+    return nullptr;
+  }
+  *count = args[1].num_.GetValue0();
+  return ArrayWrapper::GetIntArray(args[0].object_);
+}
+
+void ChannelWrapper::WriteBurstMethod(Thread *thr, Object *obj,
+				      const ValueSpan &args) {
+  uint64_t count;
+  IntArray *arr = GetBurstArray(thr, "writeBurst", args, &count);
+  if (arr == nullptr) {
+    return;
+  }
+  ChannelData *pipe_data = (ChannelData *)obj->object_specific_.get();
+  std::unique_lock<std::mutex> lock(pipe_data->mu_);
+  uint64_t i = 0;
+  while (i < count) {
+    while (pipe_data->IsFull()) {
+      BlockOnWrite(thr, obj, &lock);
+    }
+    int n = 0;
+    for (; i < count && !pipe_data->IsFull(); ++i, ++n) {
+      pipe_data->Push(arr->ReadSingle(i));
+    }
+    pipe_data->read_waiters_.Resume(n);
+  }
+}
+
+void ChannelWrapper::ReadBurstMethod(Thread *thr, Object *obj,
+				     const ValueSpan &args) {
+  uint64_t count;
+  IntArray *arr = GetBurstArray(thr, "readBurst", args, &count);
+  if (arr == nullptr) {
     return;
   }
-  const iroha::NumericValue &v = value.num_;
-  pipe_data->values_.push_back(v);
-  // Wake readers.
-  pipe_data->read_waiters_.ResumeAll();
+  ChannelData *pipe_data = (ChannelData *)obj->object_specific_.get();
+  iroha::NumericWidth w(false, pipe_data->width_);
+  std::unique_lock<std::mutex> lock(pipe_data->mu_);
+  uint64_t i = 0;
+  while (i < count) {
+    while (pipe_data->IsEmpty()) {
+      BlockOnRead(thr, obj, &lock);
+    }
+    int n = 0;
+    for (; i < count && !pipe_data->IsEmpty(); ++i, ++n) {
+      arr->WriteSingle(i, w, pipe_data->Pop());
+    }
+    pipe_data->write_waiters_.Resume(n);
+  }
 }
 
-void ChannelWrapper::BlockOnRead(Thread *thr, Object *obj) {
+void ChannelWrapper::BlockOnRead(Thread *thr, Object *obj,
+				 std::unique_lock<std::mutex> *lock) {
   ChannelData *pipe_data = (ChannelData *)obj->object_specific_.get();
-  pipe_data->read_waiters_.AddThread(thr);
+  pipe_data->read_waiters_.Wait(thr, lock);
 }
 
-void ChannelWrapper::BlockOnWrite(Thread *thr, Object *obj) {
+void ChannelWrapper::BlockOnWrite(Thread *thr, Object *obj,
+				  std::unique_lock<std::mutex> *lock) {
   ChannelData *pipe_data = (ChannelData *)obj->object_specific_.get();
-  pipe_data->write_waiters_.AddThread(thr);
+  pipe_data->write_waiters_.Wait(thr, lock);
 }
 
 }  // namespace vm
@@ -4,6 +4,8 @@
 
 #include "vm/common.h"
 
+#include <mutex>
+
 namespace vm {
 
 class ChannelWrapper {
@@ -15,15 +17,25 @@ public:
   static int ChannelWidth(Object *obj);
   static int ChannelDepth(Object *obj);
 
-  static void ReadMethod(Thread *thr, Object *obj, const vector<Value> &args);
-  static void WriteMethod(Thread *thr, Object *obj, const vector<Value> &args);
+  static void ReadMethod(Thread *thr, Object *obj, const ValueSpan &args);
+  static void WriteMethod(Thread *thr, Object *obj, const ValueSpan &args);
+  // Moves count values from or to arr[0] ... arr[count - 1].
+  // Blocks until all of them are transferred.
+  static void WriteBurstMethod(Thread *thr, Object *obj,
+			       const ValueSpan &args);
+  static void ReadBurstMethod(Thread *thr, Object *obj,
+			      const ValueSpan &args);
 
   static void WriteValue(const Value &value, Thread *thr, Object *obj);
-  static bool ReadValue(Thread *thr, Object *obj, Value *value);
+  static void ReadValue(Thread *thr, Object *obj, Value *value);
 
 private:
-  static void BlockOnRead(Thread *thr, Object *obj);
-  static void BlockOnWrite(Thread *thr, Object *obj);
+  static IntArray *GetBurstArray(Thread *thr, const char *name,
+				 const ValueSpan &args, uint64_t *count);
+  static void BlockOnRead(Thread *thr, Object *obj,
+			  std::unique_lock<std::mutex> *lock);
+  static void BlockOnWrite(Thread *thr, Object *obj,
+			   std::unique_lock<std::mutex> *lock);
 };
 
 }  // namespace vm
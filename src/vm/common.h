@@ -22,6 +22,7 @@ class NumericWidth;
 
 namespace vm {
 
+class Coroutine;
 class EnumType;
 class GC;
 class Insn;
@@ -31,9 +32,13 @@ class MethodFrame;
 class Object;
 class Profile;
 class Register;
+class Shape;
 class Thread;
+class TimerWheel;
 class Value;
+class ValueSpan;
 class VM;
+class WorkerPool;
 
 }  // namespace vm
 
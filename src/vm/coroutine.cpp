@@ -0,0 +1,143 @@
+#include "vm/coroutine.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+extern "C" {
+// Saves the callee saved registers and the floating point control words
+// (MXCSR and x87 CW, callee saved in the ABI) on the current stack, stores
+// the stack pointer to *from_sp and restores them from to_sp.
+void karuta_switch_stack(void **from_sp, void *to_sp);
+// The first return address of a new stack. Calls %r12(%rbx).
+void karuta_start_stack();
+}
+
+asm(R"(
+	.text
+	.globl karuta_switch_stack
+	.type karuta_switch_stack, @function
+karuta_switch_stack:
+	pushq %rbp
+	pushq %rbx
+	pushq %r12
+	pushq %r13
+	pushq %r14
+	pushq %r15
+	subq $8, %rsp
+	stmxcsr (%rsp)
+	fnstcw 4(%rsp)
+	movq %rsp, (%rdi)
+	movq %rsi, %rsp
+	ldmxcsr (%rsp)
+	fldcw 4(%rsp)
+	addq $8, %rsp
+	popq %r15
+	popq %r14
+	popq %r13
+	popq %r12
+	popq %rbx
+	popq %rbp
+	ret
+	.size karuta_switch_stack, .-karuta_switch_stack
+
+	.globl karuta_start_stack
+	.type karuta_start_stack, @function
+karuta_start_stack:
+	movq %rbx, %rdi
+	callq *%r12
+	ud2
+	.size karuta_start_stack, .-karuta_start_stack
+	.section .note.GNU-stack, "", @progbits
+	.text
+)");
+#endif
+
+namespace vm {
+
+// Compiler and synthesizer may run on the stack, so this is same as the
+// usual main thread. Pages are committed on demand.
+static const size_t kStackSize = 8 * 1024 * 1024;
+
+Coroutine::Coroutine(void (*fn)(void *), void *arg)
+  : fn_(fn), arg_(arg), stack_(nullptr), done_(false) {
+}
+
+Coroutine::~Coroutine() {
+  if (stack_ != nullptr) {
+    munmap(stack_, kStackSize);
+  }
+}
+
+void Coroutine::Resume() {
+  if (stack_ == nullptr) {
+    AllocateStack();
+  }
+#if defined(__x86_64__)
+  karuta_switch_stack(&caller_sp_, sp_);
+#else
+  swapcontext(&caller_context_, &context_);
+#endif
+}
+
+void Coroutine::Suspend() {
+#if defined(__x86_64__)
+  karuta_switch_stack(&sp_, caller_sp_);
+#else
+  swapcontext(&context_, &caller_context_);
+#endif
+}
+
+bool Coroutine::IsDone() const {
+  return done_;
+}
+
+void Coroutine::AllocateStack() {
+  void *p = mmap(nullptr, kStackSize, PROT_READ | PROT_WRITE,
+		 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK,
+		 -1, 0);
+  CHECK(p != MAP_FAILED) << "Failed to allocate a thread stack";
+  stack_ = (char *)p;
+  // Guard page to catch overflows.
+  mprotect(stack_, sysconf(_SC_PAGESIZE), PROT_NONE);
+#if defined(__x86_64__)
+  // Pops the control words and 6 registers (%rbx = this, %r12 = Entry)
+  // and returns to karuta_start_stack with 16 bytes aligned %rsp.
+  uint64_t *sp = (uint64_t *)(stack_ + kStackSize);
+  *(--sp) = (uint64_t)&karuta_start_stack;
+  *(--sp) = 0;  // %rbp
+  *(--sp) = (uint64_t)this;  // %rbx
+  *(--sp) = (uint64_t)&Coroutine::Entry;  // %r12
+  *(--sp) = 0;  // %r13
+  *(--sp) = 0;  // %r14
+  *(--sp) = 0;  // %r15
+  // Starts with the control words of the creator.
+  uint32_t *cw = (uint32_t *)(--sp);
+  asm volatile("stmxcsr %0" : "=m"(cw[0]));
+  asm volatile("fnstcw %0" : "=m"(*(uint16_t *)&cw[1]));
+  sp_ = sp;
+#else
+  getcontext(&context_);
+  context_.uc_stack.ss_sp = stack_;
+  context_.uc_stack.ss_size = kStackSize;
+  context_.uc_link = nullptr;
+  uint64_t self = (uint64_t)this;
+  makecontext(&context_, (void (*)())&Coroutine::EntryWithContext, 2,
+	      (uint32_t)(self >> 32), (uint32_t)self);
+#endif
+}
+
+void Coroutine::Entry(Coroutine *co) {
+  co->fn_(co->arg_);
+  co->done_ = true;
+  // Never resumed again.
+  co->Suspend();
+}
+
+#if !defined(__x86_64__)
+void Coroutine::EntryWithContext(uint32_t hi, uint32_t lo) {
+  Entry((Coroutine *)(((uint64_t)hi << 32) | lo));
+}
+#endif
+
+}  // namespace vm
@@ -0,0 +1,53 @@
+// -*- C++ -*-
+#ifndef _vm_coroutine_h_
+#define _vm_coroutine_h_
+
+#include "vm/common.h"
+
+#if !defined(__x86_64__)
+#include <ucontext.h>
+#endif
+
+namespace vm {
+
+// Runs a function on its own stack. The function can switch back to the
+// caller of Resume() in the middle and continues from there on the next
+// Resume().
+// On x86-64, only the callee saved registers and the floating point
+// control words are switched. swapcontext() is used on other
+// architectures, but it also saves the signal mask with a system call.
+class Coroutine {
+public:
+  Coroutine(void (*fn)(void *), void *arg);
+  ~Coroutine();
+
+  // Runs the function until it calls Suspend() or returns.
+  void Resume();
+  // Called from the function.
+  void Suspend();
+  bool IsDone() const;
+
+private:
+  void AllocateStack();
+  static void Entry(Coroutine *co);
+#if !defined(__x86_64__)
+  static void EntryWithContext(uint32_t hi, uint32_t lo);
+#endif
+
+  void (*fn_)(void *);
+  void *arg_;
+  // Allocated at the first Resume().
+  char *stack_;
+#if defined(__x86_64__)
+  void *sp_;
+  void *caller_sp_;
+#else
+  ucontext_t context_;
+  ucontext_t caller_context_;
+#endif
+  bool done_;
+};
+
+}  // namespace vm
+
+#endif  // _vm_coroutine_h_
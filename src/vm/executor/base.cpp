@@ -26,9 +26,10 @@
 namespace vm {
 namespace executor {
 
+template<bool kTopLevel>
 void Base::ExecNum() {
   Register *d = dreg(0);
-  if (IsTopLevel()) {
+  if (kTopLevel) {
     d->type_.value_type_ = Value::NUM;
     d->type_.width_ = sreg(0)->initial_num_.type_;
   }
@@ -39,20 +40,26 @@ void Base::ExecNum() {
 				     &VAL(d).num_);
 }
 
+template<bool kTopLevel>
 void Base::ExecStr() {
   Value &v = VAL(dreg(0));
   v.object_ =
     StringWrapper::NewStringWrapper(thr_->GetVM(), InsnOpUtils::Str(insn_));
-  if (IsTopLevel()) {
+  if (kTopLevel) {
     v.type_ = Value::OBJECT;
   }
 }
 
+template<bool kTopLevel>
 void Base::ExecBinop() {
+  if (!kTopLevel && insn_->is_narrow_) {
+    ExecNarrowNumOp();
+    return;
+  }
   Register *dst = dreg(0);
   Register *lhs = sreg(0);
   Register *rhs = sreg(1);
-  if (IsTopLevel()) {
+  if (kTopLevel) {
     if (InsnType::IsNumCalculation(op())) {
       InsnAnnotator::AnnotateNumCalculationOp(insn_);
     }
@@ -63,7 +70,7 @@ void Base::ExecBinop() {
   }
   if (dst->type_.value_type_ != Value::NUM) {
     if (dst->type_.value_type_ == Value::NONE) {
-      CHECK(IsTopLevel());
+      CHECK(kTopLevel);
       RetryBinopWithType();
     } else {
       ExecNonNumResultBinop();
@@ -111,7 +118,7 @@ void Base::ExecBinop() {
 				       &VAL(dst).num_);
     iroha::Op::FixupValueWidth(dst->type_.width_,
 			       &VAL(dst).num_);
-    if (IsTopLevel() &&
+    if (kTopLevel &&
 	!dst->GetIsDeclaredType()) {
       dst->type_ = rhs->type_;
     }
@@ -184,9 +191,10 @@ void Base::RetryBinopWithType() {
   } else if (lhs->type_.value_type_ == Value::OBJECT) {
     dst->type_.value_type_ = Value::OBJECT;
   }
-  ExecBinop();
+  ExecBinop<true>();
 }
 
+template<bool kTopLevel, int kNumIndexes>
 void Base::ExecArrayRead() {
   CHECK(oreg() != nullptr);
   Object *array_obj = VAL(oreg()).object_;
@@ -195,10 +203,8 @@ void Base::ExecArrayRead() {
   auto *dst_reg = dreg(0);
   if (ArrayWrapper::IsIntArray(array_obj)) {
     IntArray *array = ArrayWrapper::GetIntArray(array_obj);
-    vector<uint64_t> indexes;
-    PopulateArrayIndexes(0, &indexes);
-    lhs_value.num_ = array->Read(indexes);
-    if (IsTopLevel()) {
+    lhs_value.num_ = array->ReadSingle(GetArrayAddress<kNumIndexes>(array, 0));
+    if (kTopLevel) {
       dst_reg->type_.value_type_ = Value::NUM;
       dst_reg->type_.width_ = array->GetDataWidth();
     }
@@ -207,22 +213,21 @@ void Base::ExecArrayRead() {
     int index = VAL(sreg(0)).num_.GetValue0();
     lhs_value.type_ = Value::OBJECT;
     lhs_value.object_ = ArrayWrapper::Get(array_obj, index);
-    if (IsTopLevel()) {
+    if (kTopLevel) {
       dst_reg->type_.value_type_ = Value::OBJECT;
     }
   }
 }
 
+template<int kNumIndexes>
 void Base::ExecArrayWrite() {
   CHECK(oreg() != nullptr);
   Object *array_obj = VAL(oreg()).object_;
   CHECK(array_obj);
   if (ArrayWrapper::IsIntArray(array_obj)) {
     IntArray *array = ArrayWrapper::GetIntArray(array_obj);
-    vector<uint64_t> indexes;
-    PopulateArrayIndexes(1, &indexes);
-    iroha::Numeric n(VAL(sreg(0)).num_, sreg(0)->type_.width_);
-    array->Write(indexes, n);
+    array->WriteSingle(GetArrayAddress<kNumIndexes>(array, 1),
+		       sreg(0)->type_.width_, VAL(sreg(0)).num_);
   } else {
     CHECK(ArrayWrapper::IsObjectArray(array_obj));
     Register *vobj = sreg(0);
@@ -233,13 +238,6 @@ void Base::ExecArrayWrite() {
   }
 }
 
-void Base::PopulateArrayIndexes(int start, vector<uint64_t> *indexes) {
-  for (int i = start; i < insn_->src_regs_.size(); ++i) {
-    uint64_t v = VAL(insn_->src_regs_[i]).num_.GetValue0();
-    indexes->push_back(v);
-  }
-}
-
 void Base::ExecLogicInv() {
   int v = 1;
   Register *src = sreg(0);
@@ -288,6 +286,7 @@ void Base::ExecNumUniop() {
   dst_value.num_ = res;
 }
 
+template<bool kTopLevel>
 void Base::ExecLoadObj() {
   Value &dst_value = VAL(dreg(0));
   Value *obj_value;
@@ -307,12 +306,16 @@ void Base::ExecLoadObj() {
     dst_value.object_ = frame_->obj_;
     dst_value.type_ = Value::OBJECT;
   }
-  if (IsTopLevel()) {
+  if (kTopLevel) {
     dreg(0)->type_.value_type_ = Value::OBJECT;
   }
 }
 
 void Base::ExecIncDec() {
+  if (insn_->is_narrow_) {
+    ExecNarrowNumOp();
+    return;
+  }
   Register *target = dreg(0);
   iroha::NumericValue n1;
   n1.SetValue0(1);
@@ -326,6 +329,73 @@ void Base::ExecIncDec() {
   VAL(target).num_ = res;
 }
 
+void Base::ExecNarrowNumOp() {
+  uint64_t mask = insn_->narrow_mask_;
+  Value &dst = VAL(dreg(0));
+  if (op() == OP_PRE_INC || op() == OP_PRE_DEC) {
+    uint64_t v = dst.num_.GetValue0();
+    if (op() == OP_PRE_INC) {
+      ++v;
+    } else {
+      --v;
+    }
+    dst.num_.SetValue0(v & mask);
+    return;
+  }
+  uint64_t lhs = VAL(sreg(0)).num_.GetValue0();
+  uint64_t rhs = VAL(sreg(1)).num_.GetValue0();
+  switch (op()) {
+  case OP_ADD:
+    dst.num_.SetValue0((lhs + rhs) & mask);
+    break;
+  case OP_SUB:
+    dst.num_.SetValue0((lhs - rhs) & mask);
+    break;
+  case OP_MUL:
+    dst.num_.SetValue0((lhs * rhs) & mask);
+    break;
+  case OP_ASSIGN:
+    dst.num_.SetValue0(rhs & mask);
+    break;
+  case OP_AND:
+    // Logic ops don't fixup the width (same as iroha::Op::CalcBinOp).
+    dst.num_.SetValue0(lhs & rhs);
+    break;
+  case OP_OR:
+    dst.num_.SetValue0(lhs | rhs);
+    break;
+  case OP_XOR:
+    dst.num_.SetValue0(lhs ^ rhs);
+    break;
+  case OP_LSHIFT:
+    dst.num_.SetValue0(rhs < 64 ? ((lhs << rhs) & mask) : 0);
+    break;
+  case OP_RSHIFT:
+    dst.num_.SetValue0(rhs < 64 ? ((lhs >> rhs) & mask) : 0);
+    break;
+  case OP_LT:
+    dst.SetBool(lhs < rhs);
+    break;
+  case OP_GT:
+    dst.SetBool(lhs > rhs);
+    break;
+  case OP_LTE:
+    dst.SetBool(lhs <= rhs);
+    break;
+  case OP_GTE:
+    dst.SetBool(lhs >= rhs);
+    break;
+  case OP_EQ:
+    dst.SetBool(lhs == rhs);
+    break;
+  case OP_NE:
+    dst.SetBool(lhs != rhs);
+    break;
+  default:
+    CHECK(false) << "unknown narrow op:" << vm::OpCodeName(op());
+  }
+}
+
 void Base::ExecNonNumResultBinop() {
   Register *dst = dreg(0);
   Register *lhs = sreg(0);
@@ -434,26 +504,30 @@ bool Base::ExecFuncall() {
   if (callee_method == nullptr) {
     return true;
   }
-  vector<Value> args;
-  for (size_t i = 0; i < insn_->src_regs_.size(); ++i) {
-    args.push_back(VAL(insn_->src_regs_[i]));
-  }
+  return CallMethod(obj, callee_method);
+}
+
+bool Base::CallMethod(Object *obj, Method *callee_method) {
   auto fn = callee_method->GetMethodFunc();
   if (fn != nullptr) {
     // Native method call (implementation in C++).
     // Copy types of argument values too, since (most of) native methods
     // don't assume argument types.
-    for (size_t i = 0; i < insn_->src_regs_.size(); ++i) {
+    size_t num_args = insn_->src_regs_.size();
+    vector<Value> &args = thr_->NativeArgs();
+    args.resize(num_args);
+    for (size_t i = 0; i < num_args; ++i) {
+      args[i] = VAL(sreg(i));
       args[i].type_ = sreg(i)->type_.value_type_;
       args[i].num_type_ = sreg(i)->type_.width_;
     }
-    fn(thr_, obj, args);
+    fn(thr_, obj, ValueSpan(args.data(), num_args));
     if (!thr_->IsRunnable()) {
       return true;
     }
   } else {
     // Karuta method.
-    SetupCalleeFrame(obj, callee_method, args);
+    SetupCalleeFrame(obj, callee_method);
     return true;
   }
   return false;
@@ -475,7 +549,7 @@ Method *Base::LookupMethod(Object **obj) {
   Value &obj_value = VAL(oreg());
   CHECK(obj_value.IsObjectType());
   *obj = obj_value.object_;
-  Value *value = (*obj)->LookupValue(insn_->label_, false);
+  Value *value = LookupMember(*obj);
   if (!value) {
     Status::os(Status::USER_ERROR) << "method not found: "
 				   << sym_cstr(insn_->label_);
@@ -486,6 +560,19 @@ Method *Base::LookupMethod(Object **obj) {
   return value->method_;
 }
 
+Value *Base::LookupMember(Object *obj) {
+  InlineCache &cache = insn_->member_cache_;
+  Value *value = cache.Lookup(obj);
+  if (value != nullptr) {
+    return value;
+  }
+  value = obj->LookupValue(insn_->label_, false);
+  if (value != nullptr) {
+    cache.Fill(obj, insn_->label_);
+  }
+  return value;
+}
+
 void Base::ExecFuncallDone() {
   for (size_t i = 0; i < insn_->dst_regs_.size() &&
 	 i < frame_->returns_.size(); ++i) {
@@ -494,14 +581,16 @@ void Base::ExecFuncallDone() {
   frame_->returns_.clear();
 }
 
-void Base::SetupCalleeFrame(Object *obj, Method *callee_method,
-				const vector<Value> &args) {
+void Base::SetupCalleeFrame(Object *obj, Method *callee_method) {
   MethodFrame *callee_frame = thr_->PushMethodFrame(obj, callee_method);
-  for (size_t i = 0; i < args.size(); ++i) {
-    callee_frame->reg_values_[i] = args[i];
+  // Arguments go directly from the source registers to the callee.
+  Value *callee_regs = callee_frame->reg_values_.data();
+  for (size_t i = 0; i < insn_->src_regs_.size(); ++i) {
+    callee_regs[i] = VAL(sreg(i));
   }
 }
 
+template<bool kTopLevel>
 void Base::ExecMemberAccess() {
   Object *obj;
   if (op() == OP_MEMBER_READ || op() == OP_MEMBER_READ_WITH_CHECK) {
@@ -509,7 +598,7 @@ void Base::ExecMemberAccess() {
   } else {
     obj = VAL(sreg(1)).object_;
   }
-  Value *member = obj->LookupValue(insn_->label_, false);
+  Value *member = LookupMember(obj);
   if (member == nullptr) {
     Status::os(Status::USER_ERROR) << "member not found: "
 				   << sym_cstr(insn_->label_);
@@ -521,7 +610,7 @@ void Base::ExecMemberAccess() {
   }
   if (op() == OP_MEMBER_READ || op() == OP_MEMBER_READ_WITH_CHECK) {
     VAL(dreg(0)).CopyDataFrom(*member, member->num_type_);
-    if (IsTopLevel()) {
+    if (kTopLevel) {
       // Copies data type to the method.
       auto *dst_reg = dreg(0);
       dst_reg->type_.value_type_ = member->type_;
@@ -554,17 +643,22 @@ void Base::ExecBitRange() {
 }
 
 bool Base::ExecYield() {
-  return thr_->Yield();
+  thr_->MayYield();
+  return false;
 }
 
 void Base::ExecMemberReadWithCheck() {
-  ExecMemberAccess();
+  ExecMemberAccess<true>();
   // Annotate the type of the results now.
   CHECK(op() == OP_MEMBER_READ_WITH_CHECK);
   Value &obj_value = VAL(sreg(0));
   CHECK(sreg(0)->type_.value_type_ == Value::OBJECT);
   Object *obj = obj_value.object_;
   Value *member = obj->LookupValue(insn_->label_, false);
+  if (member == nullptr) {
+    // Reported by ExecMemberAccess().
+    return;
+  }
   Register *dst_reg = dreg(0);
   dst_reg->type_.value_type_ = member->type_;
   dst_reg->type_.object_name_ = member->type_object_name_;
@@ -655,13 +749,9 @@ bool Base::ExecCustomOp() {
   Method *op_method = value->method_;
   compiler::Compiler::CompileMethod(thr_->GetVM(), type_obj, op_method);
   CHECK(!op_method->IsCompileFailure());
-  vector<Value> args;
-  for (size_t i = 0; i < insn_->src_regs_.size(); ++i) {
-    args.push_back(VAL(insn_->src_regs_[i]));
-  }
   auto fn = op_method->GetMethodFunc();
   CHECK(fn == nullptr);
-  SetupCalleeFrame(type_obj, op_method, args);
+  SetupCalleeFrame(type_obj, op_method);
   return true;
 }
 
@@ -683,5 +773,25 @@ bool Base::IsCustomOpCall() {
   return false;
 }
 
+template void Base::ExecMemberAccess<true>();
+template void Base::ExecMemberAccess<false>();
+template void Base::ExecLoadObj<true>();
+template void Base::ExecLoadObj<false>();
+template void Base::ExecStr<true>();
+template void Base::ExecStr<false>();
+template void Base::ExecNum<true>();
+template void Base::ExecNum<false>();
+template void Base::ExecBinop<true>();
+template void Base::ExecBinop<false>();
+template void Base::ExecArrayRead<true, 0>();
+template void Base::ExecArrayRead<true, 1>();
+template void Base::ExecArrayRead<true, 2>();
+template void Base::ExecArrayRead<false, 0>();
+template void Base::ExecArrayRead<false, 1>();
+template void Base::ExecArrayRead<false, 2>();
+template void Base::ExecArrayWrite<0>();
+template void Base::ExecArrayWrite<1>();
+template void Base::ExecArrayWrite<2>();
+
 }  // namespace executor
 }  // namespace vm
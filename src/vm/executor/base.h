@@ -7,6 +7,7 @@
 // Mostly for inline methods.
 #include "vm/common.h"
 #include "vm/insn.h"
+#include "vm/int_array.h"
 #include "vm/method.h"
 #include "vm/method_frame.h"
 #include "vm/opcode.h"
@@ -21,19 +22,35 @@ public:
   }
   
 protected:
+  // Handlers taking kTopLevel are specialized at compile time, so
+  // non top level methods don't pay for the run time type annotation.
+  template<bool kTopLevel>
   void ExecMemberAccess();
   bool ExecFuncall();
+  // Returns true if the execution should be suspended.
+  bool CallMethod(Object *obj, Method *callee_method);
   void ExecFuncallDone();
   Method *LookupMethod(Object **obj);
+  // Looks up insn_->label_ in obj via the inline cache of insn_.
+  Value *LookupMember(Object *obj);
   Method *LookupCompiledMethod(Object **obj);
+  template<bool kTopLevel>
   void ExecLoadObj();
-  void SetupCalleeFrame(Object *obj, Method *callee_method,
-			const vector<Value> &args);
+  // Copies the source registers of insn_ to the arguments.
+  void SetupCalleeFrame(Object *obj, Method *callee_method);
+  template<bool kTopLevel>
   void ExecStr();
+  template<bool kTopLevel>
   void ExecNum();
+  template<bool kTopLevel>
   void ExecBinop();
   void ExecIncDec();
+  // uint64_t version of arithmetic, logic, shift and compare ops.
+  void ExecNarrowNumOp();
+  // kNumIndexes is the number of index registers or 0 if not known.
+  template<bool kTopLevel, int kNumIndexes = 0>
   void ExecArrayRead();
+  template<int kNumIndexes = 0>
   void ExecArrayWrite();
   void ExecNumUniop();
   void ExecLogicInv();
@@ -55,7 +72,24 @@ protected:
 
   bool IsCustomOpCall();
 
-  void PopulateArrayIndexes(int start, vector<uint64_t> *indexes);
+  // Address of the element from the index registers at and after start.
+  // Indexes beyond the dimensions of the array are ignored.
+  template<int kNumIndexes>
+  uint64_t GetArrayAddress(IntArray *array, int start) {
+    int n = kNumIndexes;
+    if (n == 0) {
+      n = insn_->src_regs_.size() - start;
+    }
+    int num_dims = array->GetNumDims();
+    if (n > num_dims) {
+      n = num_dims;
+    }
+    uint64_t addr = 0;
+    for (int i = 0; i < n; ++i) {
+      addr += array->GetDimOffset(i, VAL(sreg(start + i)).num_.GetValue0());
+    }
+    return addr;
+  }
 
   bool IsTopLevel() const {
     return frame_->method_->IsTopLevel();
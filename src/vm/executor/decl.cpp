@@ -36,9 +36,7 @@ void Decl::ExecVardecl() {
 				       nullptr, &value->num_);
     iroha::Op::MakeConst0(0, &value->num_);
   }
-  if (value->type_ == Value::OBJECT && an != nullptr) {
-    DistanceWrapper::MaySetDistanceAnnotation(name, an, thr_->GetVM(), obj);
-  }
+  bool is_object = (value->type_ == Value::OBJECT);
   if (value->type_ == Value::INT_ARRAY) {
     value->object_ = CreateMemoryObject(decl->GetWidth(),
 					decl->GetArrayShape(),
@@ -51,6 +49,10 @@ void Decl::ExecVardecl() {
   if (an != nullptr && an->IsThreadLocal()) {
     TlsWrapper::InjectTlsWrapper(thr_->GetVM(), value);
   }
+  // Done with value, as this may add a member to obj.
+  if (is_object && an != nullptr) {
+    DistanceWrapper::MaySetDistanceAnnotation(name, an, thr_->GetVM(), obj);
+  }
 }
 
 void Decl::ExecThreadDecl() {
@@ -143,7 +145,7 @@ void Decl::AddThreadEntry(const string &name, int num, bool is_soft) {
       ThreadWrapper::NewThreadWrapper(thr_->GetVM(), insn_->label_, is_soft, i);
     string thr_name = name;
     if (num > 1) {
-      char buf[20];
+      char buf[32];
       sprintf(buf, "$%dof%d", i, num);
       thr_name += string(buf);
     }
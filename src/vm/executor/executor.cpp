@@ -1,19 +1,22 @@
 #include "vm/executor/executor.h"
 
+#include "vm/method.h"
 #include "vm/thread.h"
+#include "vm/vm.h"
 
 namespace vm {
 namespace executor {
 
+template<bool kTopLevel>
 bool Executor::ExecInsn(Insn *insn) {
   insn_ = insn;
   bool need_suspend = false;
   switch (op()) {
   case OP_NUM:
-    ExecNum();
+    ExecNum<kTopLevel>();
     break;
   case OP_STR:
-    ExecStr();
+    ExecStr<kTopLevel>();
     break;
   case OP_ADD_MAY_WITH_TYPE:
   case OP_SUB_MAY_WITH_TYPE:
@@ -46,7 +49,7 @@ bool Executor::ExecInsn(Insn *insn) {
   case OP_CONCAT:
   case OP_LSHIFT:
   case OP_RSHIFT:
-    ExecBinop();
+    ExecBinop<kTopLevel>();
     break;
   case OP_FUNCALL:
     need_suspend = ExecFuncall();
@@ -58,7 +61,7 @@ bool Executor::ExecInsn(Insn *insn) {
     ExecFuncallDone();
     break;
   case OP_LOAD_OBJ:
-    ExecLoadObj();
+    ExecLoadObj<kTopLevel>();
     break;
   case OP_IF:
     {
@@ -82,7 +85,7 @@ bool Executor::ExecInsn(Insn *insn) {
     ExecIncDec();
     break;
   case OP_ARRAY_READ:
-    ExecArrayRead();
+    ExecArrayRead<kTopLevel>();
     break;
   case OP_ARRAY_WRITE:
     ExecArrayWrite();
@@ -97,7 +100,7 @@ bool Executor::ExecInsn(Insn *insn) {
     break;
   case OP_MEMBER_READ:
   case OP_MEMBER_WRITE:
-    ExecMemberAccess();
+    ExecMemberAccess<kTopLevel>();
     break;
   case OP_BIT_RANGE:
     ExecBitRange();
@@ -140,12 +143,10 @@ bool Executor::ExecInsn(Insn *insn) {
     ExecSetTypeObject();
     break;
   case OP_PUSH_CURRENT_OBJECT:
-    frame_->objs_.push_back(frame_->obj_);
-    frame_->obj_ = VAL(oreg()).object_;
+    ExecPushCurrentObject();
     break;
   case OP_POP_CURRENT_OBJECT:
-    frame_->obj_ = *(frame_->objs_.rbegin());
-    frame_->objs_.pop_back();
+    ExecPopCurrentObject();
     break;
   case OP_MAY_WITH_TYPE_DONE:
     ExecMayWithTypeDone();
@@ -157,5 +158,253 @@ bool Executor::ExecInsn(Insn *insn) {
   return need_suspend;
 }
 
+template bool Executor::ExecInsn<true>(Insn *insn);
+template bool Executor::ExecInsn<false>(Insn *insn);
+
+void Executor::ExecPushCurrentObject() {
+  frame_->objs_.push_back(frame_->obj_);
+  frame_->obj_ = VAL(oreg()).object_;
+}
+
+void Executor::ExecPopCurrentObject() {
+  frame_->obj_ = *(frame_->objs_.rbegin());
+  frame_->objs_.pop_back();
+}
+
+void Executor::DecodeMethod(Method *method) {
+  method->decoded_insns_.clear();
+  for (Insn *insn : method->insns_) {
+    DecodedInsn decoded;
+    if (method->IsTopLevel()) {
+      decoded.handler_ = GetHandler<true>(insn);
+    } else if (insn->is_narrow_) {
+      decoded.handler_ = &ExecSimpleInsn<Base, &Executor::ExecNarrowNumOp>;
+    } else {
+      decoded.handler_ = GetHandler<false>(insn);
+    }
+    decoded.insn_ = insn;
+    decoded.is_local_ = false;
+    if (!method->IsTopLevel()) {
+      if (insn->is_narrow_ || insn->op_ == OP_IF || insn->op_ == OP_GOTO ||
+	  insn->op_ == OP_NOP) {
+	decoded.is_local_ = true;
+      }
+      if (insn->op_ == OP_NUM &&
+	  !insn->dst_regs_[0]->type_.width_.IsWide()) {
+	decoded.is_local_ = true;
+      }
+    }
+    method->decoded_insns_.push_back(decoded);
+  }
+}
+
+template<bool kTopLevel>
+DecodedInsn::handler_func Executor::GetHandler(const Insn *insn) {
+  // Each handler should behave same as the corresponding case in ExecInsn().
+  switch (insn->op_) {
+  case OP_NUM:
+    return &ExecSimpleInsn<Base, &Executor::ExecNum<kTopLevel> >;
+  case OP_STR:
+    return &ExecSimpleInsn<Base, &Executor::ExecStr<kTopLevel> >;
+  case OP_ADD_MAY_WITH_TYPE:
+  case OP_SUB_MAY_WITH_TYPE:
+  case OP_MUL_MAY_WITH_TYPE:
+  case OP_DIV_MAY_WITH_TYPE:
+    return &ExecMayWithTypeInsn<kTopLevel>;
+  case OP_ADD:
+  case OP_SUB:
+  case OP_MUL:
+  case OP_DIV:
+  case OP_ASSIGN:
+  case OP_GT:
+  case OP_LT:
+  case OP_GTE:
+  case OP_LTE:
+  case OP_EQ:
+  case OP_NE:
+  case OP_LAND:
+  case OP_LOR:
+  case OP_AND:
+  case OP_OR:
+  case OP_XOR:
+  case OP_CONCAT:
+  case OP_LSHIFT:
+  case OP_RSHIFT:
+    return &ExecSimpleInsn<Base, &Executor::ExecBinop<kTopLevel> >;
+  case OP_FUNCALL:
+    return &ExecFuncallInsn;
+  case OP_FUNCALL_DONE:
+    return &ExecSimpleInsn<Base, &Executor::ExecFuncallDone>;
+  case OP_LOAD_OBJ:
+    return &ExecSimpleInsn<Base, &Executor::ExecLoadObj<kTopLevel> >;
+  case OP_IF:
+    return &ExecIfInsn;
+  case OP_GOTO:
+    return &ExecGotoInsn;
+  case OP_NOP:
+    return &ExecNopInsn;
+  case OP_YIELD:
+    return &ExecYieldInsn;
+  case OP_PRE_INC:
+  case OP_PRE_DEC:
+    return &ExecSimpleInsn<Base, &Executor::ExecIncDec>;
+  case OP_ARRAY_READ:
+    return GetArrayReadHandler<kTopLevel>(insn->src_regs_.size());
+  case OP_ARRAY_WRITE:
+    return GetArrayWriteHandler(insn->src_regs_.size() - 1);
+  case OP_LOGIC_INV:
+    return &ExecSimpleInsn<Base, &Executor::ExecLogicInv>;
+  case OP_BIT_INV:
+  case OP_PLUS:
+  case OP_MINUS:
+    return &ExecSimpleInsn<Base, &Executor::ExecNumUniop>;
+  case OP_MEMBER_READ:
+  case OP_MEMBER_WRITE:
+    return &ExecSimpleInsn<Base, &Executor::ExecMemberAccess<kTopLevel> >;
+  case OP_BIT_RANGE:
+    return &ExecSimpleInsn<Base, &Executor::ExecBitRange>;
+  case OP_FUNCDECL:
+    return &ExecSimpleInsn<Decl, &Executor::ExecFuncdecl>;
+  case OP_VARDECL:
+    return &ExecSimpleInsn<Decl, &Executor::ExecVardecl>;
+  case OP_THREAD_DECL:
+    return &ExecSimpleInsn<Decl, &Executor::ExecThreadDecl>;
+  case OP_CHANNEL_DECL:
+    return &ExecSimpleInsn<Decl, &Executor::ExecChannelDecl>;
+  case OP_MAILBOX_DECL:
+    return &ExecSimpleInsn<Decl, &Executor::ExecMailboxDecl>;
+  case OP_IMPORT:
+    return &ExecImportInsn;
+  case OP_MEMBER_READ_WITH_CHECK:
+    return &ExecSimpleInsn<Base, &Executor::ExecMemberReadWithCheck>;
+  case OP_ARRAY_WRITE_WITH_CHECK:
+    return &ExecSimpleInsn<Base, &Executor::ExecArrayWriteWithCheck>;
+  case OP_FUNCALL_WITH_CHECK:
+    return &ExecFuncallWithCheckInsn;
+  case OP_FUNCALL_DONE_WITH_CHECK:
+    return &ExecSimpleInsn<Base, &Executor::ExecFuncallDoneWithCheck>;
+  case OP_SET_TYPE_OBJECT:
+    return &ExecSimpleInsn<Base, &Executor::ExecSetTypeObject>;
+  case OP_PUSH_CURRENT_OBJECT:
+    return &ExecSimpleInsn<Executor, &Executor::ExecPushCurrentObject>;
+  case OP_POP_CURRENT_OBJECT:
+    return &ExecSimpleInsn<Executor, &Executor::ExecPopCurrentObject>;
+  case OP_MAY_WITH_TYPE_DONE:
+    return &ExecSimpleInsn<Base, &Executor::ExecMayWithTypeDone>;
+  default:
+    return &ExecInvalidInsn;
+  }
+}
+
+template<bool kTopLevel>
+DecodedInsn::handler_func Executor::GetArrayReadHandler(int num_indexes) {
+  if (num_indexes == 1) {
+    return &ExecSimpleInsn<Base, &Executor::ExecArrayRead<kTopLevel, 1> >;
+  }
+  if (num_indexes == 2) {
+    return &ExecSimpleInsn<Base, &Executor::ExecArrayRead<kTopLevel, 2> >;
+  }
+  return &ExecSimpleInsn<Base, &Executor::ExecArrayRead<kTopLevel, 0> >;
+}
+
+DecodedInsn::handler_func Executor::GetArrayWriteHandler(int num_indexes) {
+  if (num_indexes == 1) {
+    return &ExecSimpleInsn<Base, &Executor::ExecArrayWrite<1> >;
+  }
+  if (num_indexes == 2) {
+    return &ExecSimpleInsn<Base, &Executor::ExecArrayWrite<2> >;
+  }
+  return &ExecSimpleInsn<Base, &Executor::ExecArrayWrite<0> >;
+}
+
+template<bool kTopLevel>
+bool Executor::ExecMayWithTypeInsn(Executor *ex) {
+  if (ex->MayExecuteCustomOp()) {
+    if (!ex->thr_->IsRunnable()) {
+      return true;
+    }
+    ++ex->frame_->pc_;
+    return true;
+  }
+  ex->ExecBinop<kTopLevel>();
+  ++ex->frame_->pc_;
+  return false;
+}
+
+bool Executor::ExecFuncallInsn(Executor *ex) {
+  bool need_suspend = ex->ExecFuncall();
+  if (!ex->thr_->IsRunnable()) {
+    return true;
+  }
+  ++ex->frame_->pc_;
+  return need_suspend;
+}
+
+bool Executor::ExecFuncallInParallel(const DecodedInsn &decoded) {
+  insn_ = decoded.insn_;
+  VMLock &lock = thr_->GetVM()->GetLock();
+  lock.lock();
+  Object *obj;
+  Method *callee_method = LookupCompiledMethod(&obj);
+  bool need_suspend = true;
+  if (callee_method != nullptr && callee_method->IsThreadSafe()) {
+    lock.unlock();
+    thr_->SetInUnlockedNative(true);
+    need_suspend = CallMethod(obj, callee_method);
+    thr_->SetInUnlockedNative(false);
+  } else {
+    if (callee_method != nullptr) {
+      need_suspend = CallMethod(obj, callee_method);
+    }
+    lock.unlock();
+  }
+  if (!thr_->IsRunnable()) {
+    return true;
+  }
+  ++frame_->pc_;
+  return need_suspend;
+}
+
+bool Executor::ExecFuncallWithCheckInsn(Executor *ex) {
+  bool need_suspend = ex->ExecFuncallWithCheck();
+  if (!ex->thr_->IsRunnable()) {
+    return true;
+  }
+  ++ex->frame_->pc_;
+  return need_suspend;
+}
+
+bool Executor::ExecIfInsn(Executor *ex) {
+  // do not increment pc.
+  return ex->ExecIf();
+}
+
+bool Executor::ExecGotoInsn(Executor *ex) {
+  // do not increment pc.
+  return ex->ExecGoto();
+}
+
+bool Executor::ExecNopInsn(Executor *ex) {
+  ++ex->frame_->pc_;
+  return false;
+}
+
+bool Executor::ExecYieldInsn(Executor *ex) {
+  bool need_suspend = ex->ExecYield();
+  ++ex->frame_->pc_;
+  return need_suspend;
+}
+
+bool Executor::ExecImportInsn(Executor *ex) {
+  ex->ExecImport();
+  ++ex->frame_->pc_;
+  return true;
+}
+
+bool Executor::ExecInvalidInsn(Executor *ex) {
+  CHECK(false) << "unknown insn:" << vm::OpCodeName(ex->op());
+  return true;
+}
+
 }  // namespace executor
 }  // namespace vm
@@ -12,9 +12,51 @@ public:
   Executor(Thread *thread, MethodFrame *frame) : Decl(thread, frame) {
   }
 
+  template<bool kTopLevel>
   bool ExecInsn(Insn *insn);
+  bool ExecDecodedInsn(const DecodedInsn &decoded) {
+    insn_ = decoded.insn_;
+    return decoded.handler_(this);
+  }
+
+  // Runs an OP_FUNCALL insn under --workers. Takes the VM lock only to
+  // look up the method if it's a thread safe native method.
+  bool ExecFuncallInParallel(const DecodedInsn &decoded);
+
+  // Builds method->decoded_insns_ from method->insns_.
+  static void DecodeMethod(Method *method);
 
 private:
+  void ExecPushCurrentObject();
+  void ExecPopCurrentObject();
+
+  template<bool kTopLevel>
+  static DecodedInsn::handler_func GetHandler(const Insn *insn);
+  // Specialized for 1 or 2 indexes.
+  template<bool kTopLevel>
+  static DecodedInsn::handler_func GetArrayReadHandler(int num_indexes);
+  static DecodedInsn::handler_func GetArrayWriteHandler(int num_indexes);
+
+  // Handlers for the direct threaded dispatch.
+  template<class T, void (T::*fn)()>
+  static bool ExecSimpleInsn(Executor *ex) {
+    // Converts to T first. Applying fn to ex directly makes gcc warn
+    // about strict aliasing.
+    T *obj = ex;
+    (obj->*fn)();
+    ++ex->frame_->pc_;
+    return false;
+  }
+  template<bool kTopLevel>
+  static bool ExecMayWithTypeInsn(Executor *ex);
+  static bool ExecFuncallInsn(Executor *ex);
+  static bool ExecFuncallWithCheckInsn(Executor *ex);
+  static bool ExecIfInsn(Executor *ex);
+  static bool ExecGotoInsn(Executor *ex);
+  static bool ExecNopInsn(Executor *ex);
+  static bool ExecYieldInsn(Executor *ex);
+  static bool ExecImportInsn(Executor *ex);
+  static bool ExecInvalidInsn(Executor *ex);
 };
 
 }  // namespace executor
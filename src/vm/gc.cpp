@@ -1,92 +1,226 @@
 #include "vm/gc.h"
 
+#include "karuta/env.h"
+#include "vm/method.h"
 #include "vm/method_frame.h"
 #include "vm/object.h"
 #include "vm/thread.h"
 #include "vm/vm.h"
 
+#include <chrono>
+
 namespace vm {
 
-GC::GC(VM *vm, set<Thread *> *threads, set<Object *> *objs)
-  : vm_(vm), threads_(threads), objs_(objs) {
+GC::GC(VM *vm, vector<Thread *> *threads, Pool<Method> *methods)
+  : vm_(vm), threads_(threads), methods_(methods), full_(false),
+    requested_(false), requested_full_(false),
+    arena_(new ObjectArena()), young_list_(nullptr), num_young_(0),
+    num_objects_(0), young_bytes_(0), old_bytes_(0), peak_bytes_(0),
+    num_collections_(0), num_full_collections_(0),
+    total_pause_usec_(0), max_pause_usec_(0) {
+  full_limit_ = Env::GetGCHeapTarget();
+  young_limit_ = full_limit_ / 4;
+}
+
+GC::~GC() {
+}
+
+Object *GC::NewObject() {
+  Object *obj = arena_->New(vm_);
+  obj->gc_next_ = young_list_;
+  young_list_ = obj;
+  ++num_young_;
+  ++num_objects_;
+  young_bytes_ += sizeof(Object);
+  return obj;
+}
+
+void GC::Remember(Object *obj) {
+  obj->gc_remembered_ = true;
+  remembered_.push_back(obj);
 }
-  
-void GC::Run(VM *vm, set<Thread *> *threads, set<Object *> *objs) {
-  GC gc(vm, threads, objs);
-  gc.Collect();
+
+void GC::Request(bool full) {
+  requested_full_ = (requested_ && requested_full_) || full;
+  requested_ = true;
+}
+
+void GC::Collect(bool full) {
+  auto start = std::chrono::steady_clock::now();
+  full_ = full;
+  MarkRoots();
+  if (!full_) {
+    // Young objects referenced only from old objects.
+    for (Object *o : remembered_) {
+      o->Scan(this);
+    }
+  }
+  Drain();
+  if (old_bytes_ + young_bytes_ > peak_bytes_) {
+    peak_bytes_ = old_bytes_ + young_bytes_;
+  }
+  for (Object *o : remembered_) {
+    o->gc_remembered_ = false;
+  }
+  remembered_.clear();
+  LOG(INFO) << "GC: " << (full_ ? "full" : "minor")
+	    << " young=" << num_young_ << " all=" << num_objects_;
+  // Every young survivor gets promoted, so no old object points to a
+  // young one after this.
+  int num_garbages;
+  if (full_) {
+    num_garbages = SweepAll();
+    ++num_full_collections_;
+  } else {
+    num_garbages = SweepYoung();
+  }
+  young_list_ = nullptr;
+  num_young_ = 0;
+  num_objects_ -= num_garbages;
+  young_bytes_ = 0;
+  LOG(INFO) << "GC: Garbages count=" << num_garbages;
+
+  uint64_t usec = std::chrono::duration_cast<std::chrono::microseconds>
+    (std::chrono::steady_clock::now() - start).count();
+  ++num_collections_;
+  total_pause_usec_ += usec;
+  if (usec > max_pause_usec_) {
+    max_pause_usec_ = usec;
+  }
+}
+
+void GC::CollectByPressure() {
+  bool full = (old_bytes_ + young_bytes_ >= full_limit_);
+  Collect(full);
+  if (full) {
+    // Avoids repeated full collections when most of the heap is live.
+    size_t target = Env::GetGCHeapTarget();
+    full_limit_ = (old_bytes_ * 2 > target) ? old_bytes_ * 2 : target;
+  }
+}
+
+void GC::Mark(Object *obj) {
+  if (obj == nullptr || obj->gc_marked_) {
+    return;
+  }
+  if (!full_ && obj->gc_old_) {
+    return;
+  }
+  obj->gc_marked_ = true;
+  mark_stack_.push_back(obj);
 }
 
-void GC::Collect() {
-  AddRoot(vm_->root_object_);
-  AddRoot(vm_->kernel_object_);
+void GC::MarkValue(const Value &value) {
+  Mark(value.object_);
+  if (value.type_ == Value::ENUM_ITEM) {
+    Mark((Object *)value.enum_val_.enum_type);
+  }
+}
 
+void GC::MarkRoots() {
+  Mark(vm_->root_object_);
+  Mark(vm_->kernel_object_);
   for (Thread *th : *threads_) {
     vector<MethodFrame *> &frame_stack = th->MethodStack();
     for (MethodFrame *frame : frame_stack) {
-      AddRootFromMethodFrame(frame);
+      MarkFrame(frame);
     }
   }
-  LOG(INFO) << "GC: Allocated size=" << objs_->size()
-	    << " Root size=" << reachables_.size();
-  frontier_ = reachables_;
-  Scan();
-  LOG(INFO) << "GC: Reachables size=" << reachables_.size();
-  Sweep();
-}
-
-void GC::AddRoot(Object *obj) {
-  if (obj) {
-    reachables_.insert(obj);
+  for (Method *method : methods_->ptrs_) {
+    MarkMethod(method);
   }
 }
 
-void GC::AddRootFromMethodFrame(MethodFrame *frame) {
-  AddRoot(frame->obj_);
+void GC::MarkFrame(MethodFrame *frame) {
+  Mark(frame->obj_);
   for (Value &reg : frame->reg_values_) {
-    AddRoot(reg.object_);
+    MarkValue(reg);
   }
   for (Value &reg : frame->returns_) {
-    AddRoot(reg.object_);
+    MarkValue(reg);
+  }
+  for (Object *obj : frame->objs_) {
+    Mark(obj);
   }
 }
 
-void GC::Scan() {
-  while (frontier_.size() > 0) {
-    Object *obj = *(frontier_.begin());
-    frontier_.erase(obj);
-    ScanObject(obj);
+void GC::MarkMethod(Method *method) {
+  // Types of registers can refer enum types and numeric objects.
+  for (Register *reg : method->method_regs_) {
+    Mark(reg->type_object_);
+    Mark((Object *)reg->type_.enum_type_);
+  }
+  for (Value &value : method->reg_values_template_) {
+    MarkValue(value);
+  }
+  for (RegisterType &type : method->return_types_) {
+    Mark((Object *)type.enum_type_);
   }
 }
 
-void GC::ScanObject(Object *obj) {
-  if (obj == nullptr) {
-    return;
-  }
-  for (auto &it : obj->members_) {
-    Value &value = it.second;
-    if (value.object_) {
-      Object *o = value.object_;
-      if (reachables_.find(o) == reachables_.end()) {
-	frontier_.insert(o);
-	reachables_.insert(o);
-      }
-    }
+void GC::Drain() {
+  while (!mark_stack_.empty()) {
+    Object *obj = mark_stack_.back();
+    mark_stack_.pop_back();
+    obj->Scan(this);
   }
-  obj->Scan(this);
 }
 
-void GC::Sweep() {
-  set<Object *> garbages;
-  for (Object *o : *objs_) {
-    if (reachables_.find(o) == reachables_.end()) {
-      garbages.insert(o);
+int GC::SweepYoung() {
+  int num_garbages = 0;
+  Object *next;
+  for (Object *o = young_list_; o != nullptr; o = next) {
+    next = o->gc_next_;
+    if (SweepObject(o)) {
+      ++num_garbages;
     }
   }
-  LOG(INFO) << "GC: Garbages count=" << garbages.size();
-  for (Object *o : garbages) {
-    objs_->erase(o);
-    delete o;
+  return num_garbages;
+}
+
+int GC::SweepAll() {
+  int num_garbages = 0;
+  old_bytes_ = 0;
+  arena_->ForEach([this, &num_garbages](Object *o) {
+      if (SweepObject(o)) {
+	++num_garbages;
+      }
+    });
+  arena_->ReleaseEmptySlabs();
+  return num_garbages;
+}
+
+bool GC::SweepObject(Object *obj) {
+  if (!obj->gc_marked_) {
+    arena_->Delete(obj);
+    return true;
   }
+  obj->gc_marked_ = false;
+  obj->gc_old_ = true;
+  obj->gc_next_ = nullptr;
+  old_bytes_ += obj->GetSize();
+  return false;
+}
+
+int GC::GetNumCollections() const {
+  return num_collections_;
+}
+
+uint64_t GC::GetTotalPauseUsec() const {
+  return total_pause_usec_;
+}
+
+uint64_t GC::GetMaxPauseUsec() const {
+  return max_pause_usec_;
+}
+
+void GC::DumpStats(ostream &os) const {
+  os << "gc: collections=" << num_collections_
+     << " (full=" << num_full_collections_ << ")"
+     << " pause total=" << total_pause_usec_ << "us"
+     << " max=" << max_pause_usec_ << "us"
+     << " peak heap=" << peak_bytes_ << " bytes"
+     << " objects=" << num_objects_ << "\n";
 }
 
 }  // namespace vm
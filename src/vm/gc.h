@@ -2,35 +2,94 @@
 #ifndef _vm_gc_h_
 #define _vm_gc_h_
 
+#include "base/pool.h"
+#include "vm/arena.h"
 #include "vm/common.h"
 
-#include <set>
-
-using std::set;
-
 namespace vm {
 
+// Generational mark-sweep collector.
+// New objects are young. A minor collection traces only young objects from
+// the roots and the remembered set (old objects which may point to young
+// ones) and promotes the survivors. A full collection traces everything.
+// Sizes of objects are estimated from the members (not including type
+// specific data like strings).
 class GC {
 public:
-  GC(VM *vm, set<Thread *> *threads, set<Object *> *objs);
+  GC(VM *vm, vector<Thread *> *threads, Pool<Method> *methods);
+  ~GC();
 
-  static void Run(VM *vm, set<Thread *> *threads, set<Object *> *objs);
+  Object *NewObject();
+  // Members copied to a new object.
+  void AddBytes(size_t bytes) {
+    young_bytes_ += bytes;
+  }
+  // Called via Object::WriteBarrier() when an old object is modified.
+  void Remember(Object *obj);
+  void Collect(bool full);
+  // Collects at the next MaybeCollect().
+  void Request(bool full);
+  // Called at safe points where every thread is suspended.
+  // Collects when requested or enough bytes are allocated since the last
+  // collection.
+  void MaybeCollect() {
+    if (requested_) {
+      requested_ = false;
+      Collect(requested_full_);
+    } else if (young_bytes_ >= young_limit_) {
+      CollectByPressure();
+    }
+  }
+  // Called from Object::Scan() for each referenced object.
+  void Mark(Object *obj);
+  void MarkValue(const Value &value);
 
-  void ScanObject(Object *obj);
+  int GetNumCollections() const;
+  // Pause times in micro seconds.
+  uint64_t GetTotalPauseUsec() const;
+  uint64_t GetMaxPauseUsec() const;
+  void DumpStats(ostream &os) const;
 
 private:
-  void Collect();
-  void AddRoot(Object *obj);
-  void AddRootFromMethodFrame(MethodFrame *frame);
-  void Scan();
-  void Sweep();
+  void CollectByPressure();
+  void MarkRoots();
+  void MarkFrame(MethodFrame *frame);
+  void MarkMethod(Method *method);
+  void Drain();
+  // Frees unmarked young objects and promotes the others.
+  int SweepYoung();
+  // Sweeps every object in the arena.
+  int SweepAll();
+  // Returns true if the object is freed.
+  bool SweepObject(Object *obj);
 
   VM *vm_;
-  set<Thread *> *threads_;
-  set<Object *> *objs_;
+  vector<Thread *> *threads_;
+  Pool<Method> *methods_;
+  bool full_;
+  bool requested_;
+  bool requested_full_;
+
+  std::unique_ptr<ObjectArena> arena_;
+  // Linked by Object::gc_next_.
+  Object *young_list_;
+  int num_young_;
+  int num_objects_;
+  vector<Object *> remembered_;
+  vector<Object *> mark_stack_;
+
+  // Allocated since the last collection.
+  size_t young_bytes_;
+  size_t old_bytes_;
+  size_t peak_bytes_;
+  size_t young_limit_;
+  // Next full collection happens when the heap reaches this.
+  size_t full_limit_;
 
-  set<Object *> reachables_;
-  set<Object *> frontier_;
+  int num_collections_;
+  int num_full_collections_;
+  uint64_t total_pause_usec_;
+  uint64_t max_pause_usec_;
 };
 
 }  // namespace vm
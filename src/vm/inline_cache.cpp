@@ -0,0 +1,69 @@
+#include "vm/inline_cache.h"
+
+namespace vm {
+
+uint64_t InlineCache::num_hits_;
+uint64_t InlineCache::num_misses_;
+
+InlineCache::InlineCache() {
+  Clear();
+}
+
+void InlineCache::Clear() {
+  for (int i = 0; i < kNumEntries; ++i) {
+    entries_[i].shape_ = nullptr;
+    entries_[i].index_ = -1;
+  }
+  num_entries_ = 0;
+  victim_ = 1;
+}
+
+Value *InlineCache::LookupPolymorphic(Object *obj) {
+  const Shape *shape = obj->GetShape();
+  for (int i = 1; i < num_entries_; ++i) {
+    Entry &e = entries_[i];
+    if (e.shape_ == shape) {
+      ++num_hits_;
+      return &obj->GetMemberValue(e.index_);
+    }
+  }
+  ++num_misses_;
+  return nullptr;
+}
+
+void InlineCache::Fill(Object *obj, sym_t name) {
+  const Shape *shape = obj->GetShape();
+  int index = shape->GetIndex(name);
+  if (index < 0) {
+    return;
+  }
+  Entry *e;
+  if (num_entries_ < kNumEntries) {
+    e = &entries_[num_entries_];
+    ++num_entries_;
+  } else {
+    e = &entries_[victim_];
+    ++victim_;
+    if (victim_ == kNumEntries) {
+      victim_ = 1;
+    }
+  }
+  e->shape_ = shape;
+  e->index_ = index;
+}
+void InlineCache::DumpStats(ostream &os) {
+  uint64_t total = num_hits_ + num_misses_;
+  os << "inline cache: hits=" << num_hits_
+     << " misses=" << num_misses_;
+  if (total > 0) {
+    os << " hit rate=" << (num_hits_ * 100 / total) << "%";
+  }
+  os << "\n";
+}
+
+void InlineCache::ClearStats() {
+  num_hits_ = 0;
+  num_misses_ = 0;
+}
+
+}  // namespace vm
@@ -0,0 +1,53 @@
+// -*- C++ -*-
+#ifndef _vm_inline_cache_h_
+#define _vm_inline_cache_h_
+
+#include "vm/common.h"
+#include "vm/object.h"
+
+namespace vm {
+
+// Per Insn cache of member lookups (Object::LookupValue()).
+// entries_[0] is the monomorphic entry and the rest are used as
+// polymorphic entries when the insn sees receivers of other shapes.
+// Shapes are immutable, so an entry is valid as long as the receiver
+// has the same shape.
+class InlineCache {
+public:
+  InlineCache();
+
+  static const int kNumEntries = 4;
+
+  Value *Lookup(Object *obj) {
+    if (entries_[0].shape_ == obj->GetShape()) {
+      ++num_hits_;
+      return &obj->GetMemberValue(entries_[0].index_);
+    }
+    return LookupPolymorphic(obj);
+  }
+  void Fill(Object *obj, sym_t name);
+  void Clear();
+
+  static void DumpStats(ostream &os);
+  static void ClearStats();
+
+private:
+  struct Entry {
+    const Shape *shape_;
+    int index_;
+  };
+
+  Value *LookupPolymorphic(Object *obj);
+
+  Entry entries_[kNumEntries];
+  int num_entries_;
+  // Next polymorphic entry to be replaced.
+  int victim_;
+
+  static uint64_t num_hits_;
+  static uint64_t num_misses_;
+};
+
+}  // namespace vm
+
+#endif  // _vm_inline_cache_h_
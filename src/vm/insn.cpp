@@ -10,7 +10,8 @@
 namespace vm {
 
 Insn::Insn() : obj_reg_(nullptr), method_(nullptr), jump_target_(-1),
-	       label_(nullptr), insn_expr_(nullptr), insn_stmt_(nullptr) {
+	       label_(nullptr), insn_expr_(nullptr), insn_stmt_(nullptr),
+	       is_narrow_(false), narrow_mask_(0) {
 }
 
 void Insn::Dump() const {
@@ -51,6 +52,9 @@ void Insn::Dump(DumpStream &ds) const {
   if (label_) {
     ds.os << " " << sym_cstr(label_) << ":";
   }
+  if (is_narrow_) {
+    ds.os << " narrow";
+  }
   if (op_ == OP_ARRAY_WRITE || op_ == OP_ARRAY_WRITE_WITH_CHECK) {
     ds.os << sym_cstr(insn_expr_->GetSym()) << "[]";
   }
@@ -85,6 +89,16 @@ bool InsnType::IsNumCalculation(int op) {
   return false;
 }
 
+bool InsnType::IsNarrowCandidate(int op) {
+  if (op == OP_ADD || op == OP_SUB || op == OP_MUL ||
+      op == OP_AND || op == OP_OR || op == OP_XOR ||
+      op == OP_LSHIFT || op == OP_RSHIFT ||
+      op == OP_ASSIGN || op == OP_PRE_INC || op == OP_PRE_DEC) {
+    return true;
+  }
+  return IsComparison(op);
+}
+
 const string InsnOpUtils::Str(Insn *insn) {
   if (insn->insn_expr_ != nullptr) {
     // This value is from the parse tree.
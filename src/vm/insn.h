@@ -3,10 +3,15 @@
 #define _vm_insn_h_
 
 #include "vm/common.h"
+#include "vm/inline_cache.h"
 #include "vm/opcode.h"
 
 namespace vm {
 
+namespace executor {
+class Executor;
+}  // namespace executor
+
 class Insn {
 public:
   Insn();
@@ -23,6 +28,25 @@ public:
   sym_t label_;
   fe::Expr *insn_expr_;
   fe::Stmt *insn_stmt_;
+  // Set by InsnAnnotator if every numeric operand is unsigned and fits
+  // in uint64_t. narrow_mask_ is the mask for the width of dst_regs_[0].
+  bool is_narrow_;
+  uint64_t narrow_mask_;
+  // Caches the lookup of label_ for member accesses and method calls.
+  InlineCache member_cache_;
+};
+
+// Pre-decoded form of an Insn for the direct threaded dispatch.
+// The handler executes the insn and updates pc of the frame.
+class DecodedInsn {
+public:
+  typedef bool (*handler_func)(executor::Executor *ex);
+
+  handler_func handler_;
+  Insn *insn_;
+  // Accesses only the registers of the frame (and thread local state).
+  // Workers run these without the lock of VM.
+  bool is_local_;
 };
 
 class InsnType {
@@ -31,6 +55,8 @@ public:
   static bool IsComparison(int op);
   // int, int -> int (same width)
   static bool IsNumCalculation(int op);
+  // Can be executed as uint64_t operation.
+  static bool IsNarrowCandidate(int op);
 };
 
 class InsnOpUtils {
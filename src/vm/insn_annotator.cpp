@@ -56,6 +56,44 @@ void InsnAnnotator::DoAnnotate() {
     untyped_insns = tmp_insns;
   } while (n > 0);
   PropagateType();
+  if (!method_->IsTopLevel()) {
+    // Types of top level registers can be changed during the execution.
+    MarkNarrowInsns();
+  }
+}
+
+void InsnAnnotator::MarkNarrowInsns() {
+  for (auto *insn : method_->insns_) {
+    if (!InsnType::IsNarrowCandidate(insn->op_)) {
+      continue;
+    }
+    bool is_narrow = true;
+    for (auto *reg : insn->src_regs_) {
+      if (!IsNarrowReg(reg)) {
+	is_narrow = false;
+      }
+    }
+    Register *dst = insn->dst_regs_[0];
+    if (!InsnType::IsComparison(insn->op_) && !IsNarrowReg(dst)) {
+      is_narrow = false;
+    }
+    if (!is_narrow) {
+      continue;
+    }
+    insn->is_narrow_ = true;
+    int w = dst->type_.width_.GetWidth();
+    if (w < 64) {
+      insn->narrow_mask_ = (1ULL << w) - 1;
+    } else {
+      insn->narrow_mask_ = ~0ULL;
+    }
+  }
+}
+
+bool InsnAnnotator::IsNarrowReg(Register *reg) {
+  const iroha::NumericWidth &w = reg->type_.width_;
+  return (reg->type_.value_type_ == Value::NUM &&
+	  !w.IsSigned() && w.GetWidth() > 0 && w.GetWidth() <= 64);
 }
 
 void InsnAnnotator::PropagateType() {
@@ -39,6 +39,9 @@ private:
   void TryPropagate(Insn *insn, std::set<Register *> *propagated);
 
   void SetDstRegType(Value::ValueType vtype, Insn *insn, int idx);
+  void MarkNarrowInsns();
+
+  static bool IsNarrowReg(Register *reg);
 
   static void PropagateRegWidth(Register *src1, Register *src2, Register *dst);
 
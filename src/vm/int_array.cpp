@@ -1,13 +1,23 @@
 // Memory model for interpreted Karuta
 #include "vm/int_array.h"
 
+#include "karuta/env.h"
 #include "numeric/numeric_op.h"  // from iroha
+#include "vm/mem_image.h"
 
+#include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace vm {
 
 static const int PAGE_SIZE = 1024;
+// Larger arrays are paged even if the shape is finite, so that sparse
+// accesses to a huge array don't allocate all of it.
+static const uint64_t kMaxPackedBytes = 64 * 1024 * 1024;
 
 struct IntArrayPage {
   IntArrayPage(const iroha::NumericWidth &w);
@@ -22,18 +32,157 @@ IntArrayPage::IntArrayPage(const iroha::NumericWidth &width) : width_(width) {
   }
 }
 
+// Pages are found by a radix tree of page indexes, so that any 64 bits
+// address can be used without a hash or a balanced tree. Reads from pages
+// never written return 0 without allocating them.
+class PagedIntArray : public IntArray {
+public:
+  PagedIntArray(const iroha::NumericWidth &width,
+		const vector<uint64_t> &shape)
+    : IntArray(width, shape), root_(nullptr), last_page_idx_(0),
+      last_page_(nullptr) {
+  }
+  PagedIntArray(const PagedIntArray *src);
+  virtual ~PagedIntArray();
+
+  virtual iroha::NumericValue ReadSingle(uint64_t addr);
+  virtual void WriteSingle(uint64_t addr, const iroha::NumericWidth &type,
+			   const iroha::NumericValue &data);
+
+protected:
+  virtual IntArray *Clone() const;
+
+private:
+  // 6 levels of 512 entries cover 54 bits of page indexes
+  // (64 bits address / 1024 entries per page).
+  static const int kNodeBits = 9;
+  static const int kNumLevels = 6;
+  struct PageTableNode {
+    PageTableNode();
+    // Leaf nodes have pages_.
+    union {
+      PageTableNode *children_[1 << kNodeBits];
+      IntArrayPage *pages_[1 << kNodeBits];
+    };
+  };
+
+  // Returns nullptr if the page doesn't exist and create is false.
+  IntArrayPage *FindPage(uint64_t addr, bool create);
+  IntArrayPage *WalkPageTable(uint64_t page_idx, bool create);
+  PageTableNode *CopyNode(const PageTableNode *src, int level);
+  void DeleteNode(PageTableNode *node, int level);
+
+  PageTableNode *root_;
+  // Cache of the last found page.
+  uint64_t last_page_idx_;
+  IntArrayPage *last_page_;
+};
+
+// Unsigned values are packed by data_width_ bits (up to 64) without gaps.
+class PackedIntArray : public IntArray {
+public:
+  PackedIntArray(const iroha::NumericWidth &width,
+		 const vector<uint64_t> &shape);
+  PackedIntArray(const PackedIntArray *src);
+
+  virtual iroha::NumericValue ReadSingle(uint64_t addr);
+  virtual void WriteSingle(uint64_t addr, const iroha::NumericWidth &type,
+			   const iroha::NumericValue &data);
+  virtual void Fill(uint64_t addr, uint64_t count,
+		    const iroha::NumericWidth &type,
+		    const iroha::NumericValue &data);
+  virtual void CopyFrom(uint64_t addr, IntArray *src, uint64_t src_addr,
+			uint64_t count);
+  virtual bool Equals(IntArray *other);
+  virtual const vector<uint64_t> *GetPackedWords() const;
+
+protected:
+  virtual IntArray *Clone() const;
+
+private:
+  uint64_t Get(uint64_t addr) const;
+  void Set(uint64_t addr, uint64_t v);
+
+  int width_;
+  uint64_t mask_;
+  vector<uint64_t> words_;
+};
+
+// Binary images are used as the backing store. Each value takes
+// (width + 7) / 8 bytes in the host byte order. Writes go to the file if the
+// mapping is shared, otherwise modified pages are copied.
+class MappedIntArray : public IntArray {
+public:
+  MappedIntArray(const IntArray *src, char *base, size_t map_bytes);
+  // Copies to an anonymous mapping, which doesn't refer the file.
+  MappedIntArray(const MappedIntArray *src);
+  virtual ~MappedIntArray();
+
+  static MappedIntArray *Map(const IntArray *src, const string &path,
+			     bool shared);
+
+  virtual iroha::NumericValue ReadSingle(uint64_t addr);
+  virtual void WriteSingle(uint64_t addr, const iroha::NumericWidth &type,
+			   const iroha::NumericValue &data);
+
+protected:
+  virtual IntArray *Clone() const;
+  // Flushes the mapping instead, if it's a shared mapping of path.
+  virtual bool SaveBinary(const string &path);
+
+private:
+  static char *MapAnonymous(size_t map_bytes);
+
+  int bytes_;
+  uint64_t mask_;
+  char *base_;
+  size_t map_bytes_;
+  // The mapped file, if shared.
+  bool shared_;
+  dev_t dev_;
+  ino_t ino_;
+};
+
+static int ImageBytes(const iroha::NumericWidth &width) {
+  return (width.GetWidth() + 7) / 8;
+}
+
 IntArray::~IntArray() {
   // do nothing
 }
 
 IntArray *IntArray::Create(const iroha::NumericWidth &data_width,
 			   const vector<uint64_t> &shape) {
-  return new IntArray(data_width, shape);
+  uint64_t size = 1;
+  for (uint64_t s : shape) {
+    size *= s;
+  }
+  int w = data_width.GetWidth();
+  // Signed values are kept in NumericValue as they are.
+  if (size > 0 && !data_width.IsSigned() && !data_width.IsWide() &&
+      w > 0 && w <= 64 &&
+      size <= kMaxPackedBytes * 8 / w) {
+    return new PackedIntArray(data_width, shape);
+  }
+  return new PagedIntArray(data_width, shape);
 }
 
 IntArray *IntArray::Copy(const IntArray *src) {
-  const IntArray *si = (const IntArray *)src;
-  return new IntArray(si);
+  return src->Clone();
+}
+
+IntArray *IntArray::MapImage(const IntArray *src, const string &fn,
+			     bool shared) {
+  const iroha::NumericWidth &w = src->GetDataWidth();
+  if (src->GetLength() == 0 || w.IsSigned() || w.IsWide() ||
+      w.GetWidth() == 0) {
+    return nullptr;
+  }
+  string raw_fn;
+  if (!Env::GetOutputPath(fn.c_str(), &raw_fn)) {
+    return nullptr;
+  }
+  return MappedIntArray::Map(src, raw_fn, shared);
 }
 
 IntArray::IntArray(const iroha::NumericWidth &width,
@@ -41,38 +190,407 @@ IntArray::IntArray(const iroha::NumericWidth &width,
   : shape_(shape), data_width_(width) {
   size_ = 1;
   for (uint64_t s : shape_) {
+    Dim d;
+    d.size_ = s;
+    d.stride_ = size_;
+    d.use_mask_ = ((s & (s - 1)) == 0);
+    d.mask_ = s - 1;
+    dims_.push_back(d);
     size_ *= s;
   }
 }
 
-IntArray::IntArray(const IntArray *src) {
-  data_width_ = src->GetDataWidth();
-  size_ = src->GetLength();
-  for (const auto it : src->pages_) {
-    IntArrayPage *p = new IntArrayPage(data_width_);
-    *p = *(it.second);
-    pages_[it.first] = p;
+IntArray::IntArray(const IntArray *src)
+  : shape_(src->shape_), size_(src->size_), data_width_(src->data_width_),
+    dims_(src->dims_) {
+}
+
+PagedIntArray::PageTableNode::PageTableNode() {
+  for (int i = 0; i < (1 << kNodeBits); ++i) {
+    children_[i] = nullptr;
   }
 }
 
-void IntArray::Write(const vector<uint64_t> &indexes,
-		     const iroha::Numeric &data) {
-  WriteSingle(GetIndex(indexes), data.type_, data.GetArray());
+PagedIntArray::PagedIntArray(const PagedIntArray *src)
+  : IntArray(src), root_(nullptr), last_page_idx_(0), last_page_(nullptr) {
+  if (src->root_ != nullptr) {
+    root_ = CopyNode(src->root_, kNumLevels - 1);
+  }
+}
+
+PagedIntArray::~PagedIntArray() {
+  if (root_ != nullptr) {
+    DeleteNode(root_, kNumLevels - 1);
+  }
+}
+
+IntArray *PagedIntArray::Clone() const {
+  return new PagedIntArray(this);
+}
+
+PagedIntArray::PageTableNode *
+PagedIntArray::CopyNode(const PageTableNode *src, int level) {
+  PageTableNode *node = new PageTableNode();
+  for (int i = 0; i < (1 << kNodeBits); ++i) {
+    if (level == 0) {
+      if (src->pages_[i] != nullptr) {
+	node->pages_[i] = new IntArrayPage(*src->pages_[i]);
+      }
+    } else if (src->children_[i] != nullptr) {
+      node->children_[i] = CopyNode(src->children_[i], level - 1);
+    }
+  }
+  return node;
+}
+
+void PagedIntArray::DeleteNode(PageTableNode *node, int level) {
+  for (int i = 0; i < (1 << kNodeBits); ++i) {
+    if (level == 0) {
+      delete node->pages_[i];
+    } else if (node->children_[i] != nullptr) {
+      DeleteNode(node->children_[i], level - 1);
+    }
+  }
+  delete node;
 }
 
-void IntArray::WriteSingle(uint64_t addr, const iroha::NumericWidth &width,
-			   const iroha::NumericValue &data) {
-  IntArrayPage *p = FindPage(addr);
+void PagedIntArray::WriteSingle(uint64_t addr,
+				const iroha::NumericWidth &width,
+				const iroha::NumericValue &data) {
+  IntArrayPage *p = FindPage(addr, true);
   int offset = (addr % PAGE_SIZE);
   iroha::Numeric::CopyValueWithWidth(data, width, p->width_,
 				     nullptr, &p->data_[offset]);
 }
 
+iroha::NumericValue PagedIntArray::ReadSingle(uint64_t addr) {
+  IntArrayPage *p = FindPage(addr, false);
+  if (p == nullptr) {
+    iroha::NumericValue v;
+    iroha::Numeric::Clear(data_width_, &v);
+    return v;
+  }
+  int offset = (addr % PAGE_SIZE);
+  return p->data_[offset];
+}
+
+IntArrayPage *PagedIntArray::FindPage(uint64_t addr, bool create) {
+  uint64_t page_idx = addr / PAGE_SIZE;
+  if (last_page_ != nullptr && last_page_idx_ == page_idx) {
+    return last_page_;
+  }
+  IntArrayPage *p = WalkPageTable(page_idx, create);
+  if (p != nullptr) {
+    last_page_idx_ = page_idx;
+    last_page_ = p;
+  }
+  return p;
+}
+
+IntArrayPage *PagedIntArray::WalkPageTable(uint64_t page_idx, bool create) {
+  static const uint64_t kMask = (1 << kNodeBits) - 1;
+  if (root_ == nullptr) {
+    if (!create) {
+      return nullptr;
+    }
+    root_ = new PageTableNode();
+  }
+  PageTableNode *node = root_;
+  for (int level = kNumLevels - 1; level > 0; --level) {
+    PageTableNode *&child =
+      node->children_[(page_idx >> (level * kNodeBits)) & kMask];
+    if (child == nullptr) {
+      if (!create) {
+	return nullptr;
+      }
+      child = new PageTableNode();
+    }
+    node = child;
+  }
+  IntArrayPage *&page = node->pages_[page_idx & kMask];
+  if (page == nullptr && create) {
+    page = new IntArrayPage(data_width_);
+  }
+  return page;
+}
+
+PackedIntArray::PackedIntArray(const iroha::NumericWidth &width,
+			       const vector<uint64_t> &shape)
+  : IntArray(width, shape) {
+  width_ = data_width_.GetWidth();
+  mask_ = (width_ == 64) ? ~0ULL : ((1ULL << width_) - 1);
+  words_.resize((size_ * width_ + 63) / 64);
+}
+
+PackedIntArray::PackedIntArray(const PackedIntArray *src)
+  : IntArray(src), width_(src->width_), mask_(src->mask_),
+    words_(src->words_) {
+}
+
+IntArray *PackedIntArray::Clone() const {
+  return new PackedIntArray(this);
+}
+
+iroha::NumericValue PackedIntArray::ReadSingle(uint64_t addr) {
+  iroha::NumericValue v;
+  iroha::Numeric::Clear(data_width_, &v);
+  v.SetValue0(Get(addr));
+  return v;
+}
+
+void PackedIntArray::WriteSingle(uint64_t addr,
+				 const iroha::NumericWidth &width,
+				 const iroha::NumericValue &data) {
+  iroha::NumericValue v;
+  iroha::Numeric::CopyValueWithWidth(data, width, data_width_, nullptr, &v);
+  Set(addr, v.GetValue0());
+}
+
+// width bits (1 to 64) from the bit position.
+static inline uint64_t GetBits(const uint64_t *words, uint64_t bit, int width,
+			       uint64_t mask) {
+  uint64_t word = bit / 64;
+  int offset = bit % 64;
+  uint64_t v = words[word] >> offset;
+  if (offset + width > 64) {
+    v |= words[word + 1] << (64 - offset);
+  }
+  return v & mask;
+}
+
+static inline void SetBits(uint64_t *words, uint64_t bit, int width,
+			   uint64_t mask, uint64_t v) {
+  v &= mask;
+  uint64_t word = bit / 64;
+  int offset = bit % 64;
+  words[word] = (words[word] & ~(mask << offset)) | (v << offset);
+  if (offset + width > 64) {
+    int hi = 64 - offset;
+    words[word + 1] = (words[word + 1] & ~(mask >> hi)) | (v >> hi);
+  }
+}
+
+// Copies num_bits bits by up to 64 bits at once. Ranges should not overlap.
+static void CopyBits(uint64_t *dst, uint64_t dst_bit, const uint64_t *src,
+		     uint64_t src_bit, uint64_t num_bits) {
+  while (num_bits >= 64) {
+    SetBits(dst, dst_bit, 64, ~0ULL, GetBits(src, src_bit, 64, ~0ULL));
+    dst_bit += 64;
+    src_bit += 64;
+    num_bits -= 64;
+  }
+  if (num_bits > 0) {
+    uint64_t mask = (1ULL << num_bits) - 1;
+    SetBits(dst, dst_bit, num_bits, mask,
+	    GetBits(src, src_bit, num_bits, mask));
+  }
+}
+
+uint64_t PackedIntArray::Get(uint64_t addr) const {
+  return GetBits(&words_[0], Wrap(addr) * width_, width_, mask_);
+}
+
+void PackedIntArray::Set(uint64_t addr, uint64_t v) {
+  SetBits(&words_[0], Wrap(addr) * width_, width_, mask_, v);
+}
+
+const vector<uint64_t> *PackedIntArray::GetPackedWords() const {
+  return &words_;
+}
+
+void PackedIntArray::Fill(uint64_t addr, uint64_t count,
+			  const iroha::NumericWidth &width,
+			  const iroha::NumericValue &data) {
+  iroha::NumericValue nv;
+  iroha::Numeric::CopyValueWithWidth(data, width, data_width_, nullptr, &nv);
+  uint64_t v = nv.GetValue0() & mask_;
+  count = std::min(count, size_);
+  addr = Wrap(addr);
+  // Values repeated in a word, if they don't straddle words.
+  bool use_pattern = (64 % width_ == 0);
+  uint64_t pattern = 0;
+  if (use_pattern) {
+    for (int i = 0; i < 64; i += width_) {
+      pattern |= v << i;
+    }
+  }
+  while (count > 0) {
+    uint64_t n = std::min(count, size_ - addr);
+    count -= n;
+    for (; n > 0 && (!use_pattern || (addr * width_) % 64 != 0); --n) {
+      Set(addr++, v);
+    }
+    if (use_pattern) {
+      uint64_t word = addr * width_ / 64;
+      uint64_t num_words = n * width_ / 64;
+      std::fill(words_.begin() + word, words_.begin() + word + num_words,
+		pattern);
+      addr += num_words * 64 / width_;
+      n -= num_words * 64 / width_;
+    }
+    for (; n > 0; --n) {
+      Set(addr++, v);
+    }
+    addr = Wrap(addr);
+  }
+}
+
+void PackedIntArray::CopyFrom(uint64_t addr, IntArray *src, uint64_t src_addr,
+			      uint64_t count) {
+  const vector<uint64_t> *src_words = src->GetPackedWords();
+  uint64_t src_size = src->GetLength();
+  if (src_words == nullptr || src->GetDataWidth().GetWidth() != width_ ||
+      count > size_ || count > src_size) {
+    IntArray::CopyFrom(addr, src, src_addr, count);
+    return;
+  }
+  addr = Wrap(addr);
+  src_addr %= src_size;
+  vector<uint64_t> tmp;
+  if (src == this) {
+    tmp = words_;
+    src_words = &tmp;
+  }
+  // Splits at the ends of both arrays.
+  while (count > 0) {
+    uint64_t n = std::min(count, std::min(size_ - addr, src_size - src_addr));
+    CopyBits(&words_[0], addr * width_, &(*src_words)[0], src_addr * width_,
+	     n * width_);
+    count -= n;
+    addr = Wrap(addr + n);
+    src_addr = (src_addr + n) % src_size;
+  }
+}
+
+bool PackedIntArray::Equals(IntArray *other) {
+  const vector<uint64_t> *other_words = other->GetPackedWords();
+  if (other_words == nullptr) {
+    return IntArray::Equals(other);
+  }
+  // Unused bits are always 0.
+  return other->GetDataWidth().GetWidth() == width_ &&
+    other->GetShape() == shape_ && *other_words == words_;
+}
+
+MappedIntArray::MappedIntArray(const IntArray *src, char *base,
+			       size_t map_bytes)
+  : IntArray(src), bytes_(ImageBytes(data_width_)), base_(base),
+    map_bytes_(map_bytes), shared_(false) {
+  int w = data_width_.GetWidth();
+  mask_ = (w == 64) ? ~0ULL : ((1ULL << w) - 1);
+}
+
+MappedIntArray::MappedIntArray(const MappedIntArray *src)
+  : IntArray(src), bytes_(src->bytes_), mask_(src->mask_),
+    map_bytes_(src->map_bytes_), shared_(false) {
+  base_ = MapAnonymous(map_bytes_);
+  memcpy(base_, src->base_, size_ * bytes_);
+}
+
+MappedIntArray::~MappedIntArray() {
+  munmap(base_, map_bytes_);
+}
+
+IntArray *MappedIntArray::Clone() const {
+  return new MappedIntArray(this);
+}
+
+char *MappedIntArray::MapAnonymous(size_t map_bytes) {
+  void *p = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE,
+		 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  CHECK(p != MAP_FAILED) << "Failed to map an array";
+  return (char *)p;
+}
+
+MappedIntArray *MappedIntArray::Map(const IntArray *src, const string &path,
+				    bool shared) {
+  int fd = open(path.c_str(), shared ? O_RDWR : O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return nullptr;
+  }
+  size_t num_bytes = src->GetLength() * ImageBytes(src->GetDataWidth());
+  // Loading doesn't change the file. A short image is read instead.
+  if (st.st_size < num_bytes) {
+    close(fd);
+    return nullptr;
+  }
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t map_bytes = (num_bytes + page_size - 1) / page_size * page_size;
+  void *p = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE,
+		 shared ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+  if (p == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  char *base = (char *)p;
+  // The mapping is kept after close().
+  close(fd);
+  MappedIntArray *arr = new MappedIntArray(src, base, map_bytes);
+  if (shared) {
+    arr->shared_ = true;
+    arr->dev_ = st.st_dev;
+    arr->ino_ = st.st_ino;
+  }
+  return arr;
+}
+
+bool MappedIntArray::SaveBinary(const string &path) {
+  struct stat st;
+  if (!shared_ || stat(path.c_str(), &st) < 0 ||
+      st.st_dev != dev_ || st.st_ino != ino_) {
+    return IntArray::SaveBinary(path);
+  }
+  // The file already has the values. Replacing it would detach this.
+  // Trailing bytes beyond the array are dropped as IntArray::SaveBinary()
+  // writes just the array.
+  size_t num_bytes = size_ * bytes_;
+  return (msync(base_, map_bytes_, MS_SYNC) == 0 &&
+	  (st.st_size == num_bytes || truncate(path.c_str(), num_bytes) == 0));
+}
+
+iroha::NumericValue MappedIntArray::ReadSingle(uint64_t addr) {
+  if (addr >= size_) {
+    addr %= size_;
+  }
+  uint64_t v = 0;
+  memcpy(&v, base_ + addr * bytes_, bytes_);
+  iroha::NumericValue nv;
+  iroha::Numeric::Clear(data_width_, &nv);
+  nv.SetValue0(v & mask_);
+  return nv;
+}
+
+void MappedIntArray::WriteSingle(uint64_t addr,
+				 const iroha::NumericWidth &width,
+				 const iroha::NumericValue &data) {
+  if (addr >= size_) {
+    addr %= size_;
+  }
+  iroha::NumericValue v;
+  iroha::Numeric::CopyValueWithWidth(data, width, data_width_, nullptr, &v);
+  uint64_t d = v.GetValue0() & mask_;
+  memcpy(base_ + addr * bytes_, &d, bytes_);
+}
+
+void IntArray::Write(const vector<uint64_t> &indexes,
+		     const iroha::Numeric &data) {
+  WriteSingle(GetIndex(indexes), data.type_, data.GetArray());
+}
+
 void IntArray::WriteWide(uint64_t byte_addr, const iroha::NumericWidth &type,
 			 const iroha::NumericValue &data) {
   int mem_width = data_width_.GetWidth();
   uint64_t array_addr = byte_addr / (mem_width / 8);
   int c = type.GetWidth() / mem_width;
+  if (c == 1) {
+    WriteSingle(array_addr, type, data);
+    return;
+  }
   for (int i = 0; i < c; ++i) {
     int l = mem_width * i;
     iroha::Numeric d;
@@ -86,17 +604,16 @@ iroha::NumericValue IntArray::Read(const vector<uint64_t> &indexes) {
   return ReadSingle(GetIndex(indexes));
 }
 
-iroha::NumericValue IntArray::ReadSingle(uint64_t addr) {
-  IntArrayPage *p = FindPage(addr);
-  int offset = (addr % PAGE_SIZE);
-  return p->data_[offset];
-}
-
 iroha::Numeric IntArray::ReadWide(uint64_t byte_addr, int width) {
   int data_bits = data_width_.GetWidth();
   int data_bytes = data_bits / 8;
   uint64_t array_addr = byte_addr / data_bytes;
   iroha::Numeric n;
+  if (width == data_bits) {
+    n.type_ = data_width_;
+    *n.GetMutableArray() = ReadSingle(array_addr);
+    return n;
+  }
   n.type_.SetWidth(0);
   int c = width / data_bits;
   for (int i = 0; i < c; ++i) {
@@ -109,6 +626,61 @@ iroha::Numeric IntArray::ReadWide(uint64_t byte_addr, int width) {
   return n;
 }
 
+void IntArray::Fill(uint64_t addr, uint64_t count,
+		    const iroha::NumericWidth &type,
+		    const iroha::NumericValue &data) {
+  if (size_ > 0) {
+    count = std::min(count, size_);
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    WriteSingle(Wrap(addr + i), type, data);
+  }
+}
+
+void IntArray::CopyFrom(uint64_t addr, IntArray *src, uint64_t src_addr,
+			uint64_t count) {
+  const iroha::NumericWidth &src_width = src->GetDataWidth();
+  if (src == this && addr > src_addr && addr - src_addr < count) {
+    // Copies backward not to overwrite the source.
+    for (uint64_t i = count; i > 0; --i) {
+      WriteSingle(Wrap(addr + i - 1), src_width,
+		  src->ReadSingle(src->Wrap(src_addr + i - 1)));
+    }
+    return;
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    WriteSingle(Wrap(addr + i), src_width,
+		src->ReadSingle(src->Wrap(src_addr + i)));
+  }
+}
+
+bool IntArray::Equals(IntArray *other) {
+  if (other->GetDataWidth().GetWidth() != data_width_.GetWidth() ||
+      other->GetShape() != shape_) {
+    return false;
+  }
+  for (uint64_t i = 0; i < size_; ++i) {
+    iroha::NumericValue a = ReadSingle(i);
+    iroha::NumericValue b = other->ReadSingle(i);
+    if (!data_width_.IsWide()) {
+      if (a.GetValue0() != b.GetValue0()) {
+	return false;
+      }
+      continue;
+    }
+    iroha::NumericValue x;
+    iroha::Op::CalcBinOp(iroha::BINOP_XOR, a, b, data_width_, &x);
+    if (!iroha::Op::IsZero(data_width_, x)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const vector<uint64_t> *IntArray::GetPackedWords() const {
+  return nullptr;
+}
+
 uint64_t IntArray::GetLength() const {
   return size_;
 }
@@ -126,6 +698,19 @@ bool IntArray::ImageIO(const string &fn, const string &format, bool save) {
   if (!Env::GetOutputPath(fn.c_str(), &raw_fn)) {
     return false;
   }
+  if (format.empty() || format == "shared") {
+    if (save) {
+      return SaveBinary(raw_fn);
+    }
+    return LoadBinary(raw_fn);
+  }
+  if (format == "hex" || format == "bin") {
+    int radix = (format == "hex") ? 16 : 2;
+    if (save) {
+      return MemImage::Save(raw_fn, radix, this);
+    }
+    return MemImage::Load(raw_fn, radix, this);
+  }
   FILE *fp;
   if (save) {
     fp = fopen(raw_fn.c_str(), "w");
@@ -135,29 +720,60 @@ bool IntArray::ImageIO(const string &fn, const string &format, bool save) {
   if (fp == nullptr) {
     return false;
   }
-    bool r;
-  if (format.empty()) {
-    r = BinaryIO(fp, save);
-  } else {
-    r = TextIO(fp, save);
-  }
+  bool r = TextIO(fp, save);
   fclose(fp);
   return r;
 }
 
-bool IntArray::BinaryIO(FILE *fp, bool save) {
-  int num_bytes = (data_width_.GetWidth() + 1) / 8;
-  for (int i = 0; i < GetLength(); ++i) {
-    if (save) {
-      iroha::NumericValue nv = ReadSingle(i);
-      fwrite((void *)&nv.value_[0], num_bytes, 1, fp);
+bool IntArray::LoadBinary(const string &path) {
+  FILE *fp = fopen(path.c_str(), "r");
+  if (fp == nullptr) {
+    return false;
+  }
+  int num_bytes = ImageBytes(data_width_);
+  for (uint64_t i = 0; i < GetLength(); ++i) {
+    iroha::Numeric n;
+    n.type_ = data_width_;
+    iroha::NumericValue *nv = n.GetMutableArray();
+    iroha::Numeric::Clear(data_width_, nv);
+    if (fread((void *)&nv->value_[0], num_bytes, 1, fp) != 1) {
+      break;
+    }
+    WriteSingle(i, n.type_, n.GetArray());
+  }
+  fclose(fp);
+  return true;
+}
+
+bool IntArray::SaveBinary(const string &path) {
+  int num_bytes = ImageBytes(data_width_);
+  size_t total = GetLength() * num_bytes;
+  // Writes to a new file and renames it, so that existing mappings of the
+  // old file stay valid.
+  string tmp_path = path + ".tmp";
+  int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = (ftruncate(fd, total) == 0);
+  if (ok && total > 0) {
+    void *p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+      ok = false;
     } else {
-      iroha::Numeric n;
-      iroha::NumericValue *nv = n.GetMutableArray();
-      fread((void *)&nv->value_[0], num_bytes, 1, fp);
-      WriteSingle(i, n.type_, n.GetArray());
+      char *dst = (char *)p;
+      for (uint64_t i = 0; i < GetLength(); ++i) {
+	iroha::NumericValue nv = ReadSingle(i);
+	memcpy(dst + i * num_bytes, (void *)&nv.value_[0], num_bytes);
+      }
+      munmap(p, total);
     }
   }
+  close(fd);
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
   return true;
 }
 
@@ -188,22 +804,10 @@ int IntArray::GetAddressWidth() const {
   return address_bits;
 }
 
-IntArrayPage *IntArray::FindPage(uint64_t addr) {
-  uint64_t page_idx = addr / PAGE_SIZE;
-  IntArrayPage *p = pages_[page_idx];
-  if (!p) {
-    p = new IntArrayPage(data_width_);
-    pages_[page_idx] = p;
-  }
-  return p;
-}
-
 uint64_t IntArray::GetIndex(const vector<uint64_t> &indexes) {
   uint64_t idx = 0;
-  uint64_t s = 1;
-  for (int i = 0; i < indexes.size() && i < shape_.size(); ++i) {
-    idx += s * (indexes[i] % shape_[i]);
-    s *= shape_[i];
+  for (int i = 0; i < indexes.size() && i < dims_.size(); ++i) {
+    idx += GetDimOffset(i, indexes[i]);
   }
   return idx;
 }
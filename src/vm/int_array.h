@@ -5,13 +5,13 @@
 #include "numeric/numeric_type.h"  // from iroha
 #include "vm/common.h"
 
-#include <map>
 #include <stdio.h>
 
 namespace vm {
 
-class IntArrayPage;
-
+// Arrays of a finite shape store bit packed values in a flat buffer and
+// addresses wrap around the length. Unbounded ones like the default Memory
+// (and very large, signed or wide ones) allocate pages on demand.
 class IntArray {
 public:
   IntArray(const iroha::NumericWidth &width,
@@ -22,36 +22,85 @@ public:
   static IntArray *Create(const iroha::NumericWidth &data_width,
 			  const vector<uint64_t> &shape);
   static IntArray *Copy(const IntArray *mem);
+  // Returns a new array using the binary image file as the backing store
+  // (shared: writes go to the file, otherwise copy on write), or nullptr
+  // if the file or this kind of array (unbounded, signed or wide) can't
+  // be mapped.
+  static IntArray *MapImage(const IntArray *src, const string &fn,
+			    bool shared);
 
   iroha::NumericValue Read(const vector<uint64_t> &indexes);
-  iroha::NumericValue ReadSingle(uint64_t addr);
+  virtual iroha::NumericValue ReadSingle(uint64_t addr) = 0;
   void Write(const vector<uint64_t> &indexes, const iroha::Numeric &data);
-  void WriteSingle(uint64_t addr, const iroha::NumericWidth &type,
-		   const iroha::NumericValue &data);
+  virtual void WriteSingle(uint64_t addr, const iroha::NumericWidth &type,
+			   const iroha::NumericValue &data) = 0;
   // Assumes the width of data is equal or wider than or the width
   // of this array.
   iroha::Numeric ReadWide(uint64_t byte_addr, int width);
   void WriteWide(uint64_t byte_addr, const iroha::NumericWidth &type,
 		 const iroha::NumericValue &value);
 
+  // Bulk operations. Addresses wrap around the length like ReadSingle() and
+  // WriteSingle(). src may be this array.
+  virtual void Fill(uint64_t addr, uint64_t count,
+		    const iroha::NumericWidth &type,
+		    const iroha::NumericValue &data);
+  virtual void CopyFrom(uint64_t addr, IntArray *src, uint64_t src_addr,
+			uint64_t count);
+  // Same width and shape, and same values. Compares nothing if unbounded.
+  virtual bool Equals(IntArray *other);
+  // Returns the words of bit packed values or nullptr.
+  virtual const vector<uint64_t> *GetPackedWords() const;
+
   // 0 means unlimited (is actually 2^64). typically for main memory space.
   uint64_t GetLength() const;
   int GetAddressWidth() const;
   const iroha::NumericWidth &GetDataWidth() const;
   const vector<uint64_t> &GetShape() const;
+  int GetNumDims() const {
+    return dims_.size();
+  }
+  // Offset of an index in the dim-th dimension (wraps around it).
+  // Sum of these for each dimension is the address.
+  uint64_t GetDimOffset(int dim, uint64_t index) const {
+    const Dim &d = dims_[dim];
+    if (d.use_mask_) {
+      return (index & d.mask_) * d.stride_;
+    }
+    return (index % d.size_) * d.stride_;
+  }
 
+  // format is empty or "shared" for binary images, "hex" or "bin" for
+  // $readmemh or $readmemb images and others for decimal text.
   bool ImageIO(const string &fn, const string &format, bool save);
 
-private:
-  IntArrayPage *FindPage(uint64_t addr);
-  uint64_t GetIndex(const vector<uint64_t> &indexes);
-  bool BinaryIO(FILE *fp, bool save);
-  bool TextIO(FILE *fp, bool save);
+protected:
+  virtual IntArray *Clone() const = 0;
+  // Writes a new file and renames it to path. Arrays mapping the old
+  // file keep the old contents and don't see the file any more.
+  virtual bool SaveBinary(const string &path);
+  uint64_t Wrap(uint64_t addr) const {
+    return (size_ == 0 || addr < size_) ? addr : (addr % size_);
+  }
 
   const vector<uint64_t> shape_;
   uint64_t size_;
   iroha::NumericWidth data_width_;
-  std::map<uint64_t, IntArrayPage *> pages_;
+
+private:
+  // Precomputed from the shape, so indexing doesn't need the shape.
+  struct Dim {
+    uint64_t size_;
+    uint64_t stride_;
+    // size_ - 1 if size_ is a power of 2 (~0 for 0 i.e. unbounded).
+    uint64_t mask_;
+    bool use_mask_;
+  };
+  vector<Dim> dims_;
+
+  uint64_t GetIndex(const vector<uint64_t> &indexes);
+  bool LoadBinary(const string &path);
+  bool TextIO(FILE *fp, bool save);
 };
 
 }  // namespace vm
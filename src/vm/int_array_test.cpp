@@ -1,8 +1,13 @@
 #include "vm/int_array.h"
 
 #include "iroha/test_util.h"
+#include "numeric/numeric_op.h"  // from iroha
 #include "numeric/numeric_type.h"  // from iroha
 
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace vm {
 
 void TestIntArray() {
@@ -41,6 +46,235 @@ void TestIntArray() {
     v = a->ReadSingle(0x100);
     ASSERT(v.GetValue0() == 0x5678);
   }
+  {
+    // Values across the word boundaries.
+    iroha::NumericWidth w3;
+    w3.SetWidth(3);
+    vector<uint64_t> s2;
+    s2.push_back(10);
+    s2.push_back(10);
+    std::unique_ptr<IntArray> b(IntArray::Create(w3, s2));
+    iroha::NumericWidth t;
+    iroha::NumericValue v;
+    for (int i = 0; i < 100; ++i) {
+      v.SetValue0(i);
+      b->WriteSingle(i, t, v);
+    }
+    for (int i = 0; i < 100; ++i) {
+      ASSERT(b->ReadSingle(i).GetValue0() == (i & 7));
+    }
+    vector<uint64_t> idx;
+    idx.push_back(3);
+    idx.push_back(2);
+    ASSERT(b->Read(idx).GetValue0() == (23 & 7));
+    std::unique_ptr<IntArray> c(IntArray::Copy(b.get()));
+    ASSERT(c->GetShape().size() == 2);
+    ASSERT(c->Read(idx).GetValue0() == (23 & 7));
+    v.SetValue0(0);
+    c->WriteSingle(23, t, v);
+    ASSERT(c->Read(idx).GetValue0() == 0);
+    ASSERT(b->Read(idx).GetValue0() == (23 & 7));
+  }
+  {
+    // Indexes wrap around each dimension (power of 2 or not).
+    iroha::NumericWidth w8;
+    w8.SetWidth(8);
+    vector<uint64_t> s3;
+    s3.push_back(3);
+    s3.push_back(4);
+    s3.push_back(5);
+    std::unique_ptr<IntArray> m(IntArray::Create(w8, s3));
+    ASSERT(m->GetNumDims() == 3);
+    ASSERT(m->GetDimOffset(0, 4) == 1);
+    ASSERT(m->GetDimOffset(1, 6) == 2 * 3);
+    ASSERT(m->GetDimOffset(2, 7) == 2 * 12);
+    vector<uint64_t> idx;
+    idx.push_back(5);
+    idx.push_back(9);
+    idx.push_back(3);
+    iroha::Numeric n;
+    n.type_ = w8;
+    n.GetMutableArray()->SetValue0(42);
+    m->Write(idx, n);
+    ASSERT(m->ReadSingle(2 + 1 * 3 + 3 * 12).GetValue0() == 42);
+  }
+  {
+    // Unbounded array with sparse far addresses.
+    iroha::NumericWidth w32;
+    w32.SetWidth(32);
+    vector<uint64_t> s0;
+    s0.push_back(0);
+    std::unique_ptr<IntArray> m(IntArray::Create(w32, s0));
+    iroha::NumericWidth t;
+    iroha::NumericValue v;
+    ASSERT(m->ReadSingle(0xffffffffffffffffULL).GetValue0() == 0);
+    v.SetValue0(1);
+    m->WriteSingle(0xffffffffffffffffULL, t, v);
+    v.SetValue0(2);
+    m->WriteSingle(0x100000000ULL, t, v);
+    v.SetValue0(3);
+    m->WriteSingle(5, t, v);
+    ASSERT(m->ReadSingle(0xffffffffffffffffULL).GetValue0() == 1);
+    ASSERT(m->ReadSingle(0x100000000ULL).GetValue0() == 2);
+    ASSERT(m->ReadSingle(0x100000001ULL).GetValue0() == 0);
+    ASSERT(m->ReadSingle(5).GetValue0() == 3);
+    ASSERT(m->ReadSingle(0x80000000ULL).GetValue0() == 0);
+    std::unique_ptr<IntArray> c(IntArray::Copy(m.get()));
+    v.SetValue0(4);
+    c->WriteSingle(5, t, v);
+    ASSERT(c->ReadSingle(5).GetValue0() == 4);
+    ASSERT(c->ReadSingle(0x100000000ULL).GetValue0() == 2);
+    ASSERT(m->ReadSingle(5).GetValue0() == 3);
+  }
+  {
+    // Binary images mapped as the backing store.
+    const char *fn = "int_array_test.image";
+    iroha::NumericWidth w24;
+    w24.SetWidth(24);
+    vector<uint64_t> s1;
+    s1.push_back(100);
+    std::unique_ptr<IntArray> d(IntArray::Create(w24, s1));
+    iroha::NumericWidth t;
+    iroha::NumericValue v;
+    for (int i = 0; i < 100; ++i) {
+      v.SetValue0(i * 0x10101);
+      d->WriteSingle(i, t, v);
+    }
+    ASSERT(d->ImageIO(fn, "", true));
+    std::unique_ptr<IntArray> cow(IntArray::MapImage(d.get(), fn, false));
+    ASSERT(cow.get() != nullptr);
+    ASSERT(cow->ReadSingle(99).GetValue0() == 99 * 0x10101);
+    v.SetValue0(1);
+    cow->WriteSingle(99, t, v);
+    ASSERT(cow->ReadSingle(99).GetValue0() == 1);
+    std::unique_ptr<IntArray> shared(IntArray::MapImage(d.get(), fn, true));
+    ASSERT(shared->ReadSingle(99).GetValue0() == 99 * 0x10101);
+    v.SetValue0(2);
+    shared->WriteSingle(98, t, v);
+    std::unique_ptr<IntArray> e(IntArray::Create(w24, s1));
+    ASSERT(e->ImageIO(fn, "", false));
+    ASSERT(e->ReadSingle(98).GetValue0() == 2);
+    ASSERT(e->ReadSingle(97).GetValue0() == 97 * 0x10101);
+    // Saving to the file of a shared mapping keeps it mapped.
+    ASSERT(shared->ImageIO(fn, "", true));
+    v.SetValue0(4);
+    shared->WriteSingle(97, t, v);
+    ASSERT(e->ImageIO(fn, "", false));
+    ASSERT(e->ReadSingle(97).GetValue0() == 4);
+    std::unique_ptr<IntArray> c(IntArray::Copy(shared.get()));
+    v.SetValue0(3);
+    c->WriteSingle(98, t, v);
+    ASSERT(shared->ReadSingle(98).GetValue0() == 2);
+    // A short image isn't mapped and stays as is.
+    vector<uint64_t> s2;
+    s2.push_back(200);
+    std::unique_ptr<IntArray> f(IntArray::Create(w24, s2));
+    ASSERT(IntArray::MapImage(f.get(), fn, true) == nullptr);
+    ASSERT(IntArray::MapImage(f.get(), fn, false) == nullptr);
+    struct stat st;
+    ASSERT(stat(fn, &st) == 0 && st.st_size == 300);
+    ASSERT(f->ImageIO(fn, "", false));
+    ASSERT(f->ReadSingle(99).GetValue0() == 99 * 0x10101);
+    ASSERT(f->ReadSingle(100).GetValue0() == 0);
+    unlink(fn);
+  }
+  {
+    // $readmemh / $readmemb text images.
+    const char *fn = "int_array_test.hex";
+    FILE *fp = fopen(fn, "w");
+    fprintf(fp, "// comment\n1a 2_b /* c\n */ X\n@10\nff0 // 3\n\n4\n");
+    fclose(fp);
+    iroha::NumericWidth w8;
+    w8.SetWidth(8);
+    vector<uint64_t> s1;
+    s1.push_back(32);
+    std::unique_ptr<IntArray> h(IntArray::Create(w8, s1));
+    ASSERT(h->ImageIO(fn, "hex", false));
+    ASSERT(h->ReadSingle(0).GetValue0() == 0x1a);
+    ASSERT(h->ReadSingle(1).GetValue0() == 0x2b);
+    ASSERT(h->ReadSingle(2).GetValue0() == 0);
+    ASSERT(h->ReadSingle(16).GetValue0() == 0xf0);
+    ASSERT(h->ReadSingle(17).GetValue0() == 4);
+    ASSERT(h->ImageIO(fn, "bin", true));
+    std::unique_ptr<IntArray> b(IntArray::Create(w8, s1));
+    ASSERT(b->ImageIO(fn, "bin", false));
+    ASSERT(b->ReadSingle(1).GetValue0() == 0x2b);
+    ASSERT(b->ReadSingle(16).GetValue0() == 0xf0);
+    fp = fopen(fn, "w");
+    fprintf(fp, "12 3g\n");
+    fclose(fp);
+    ASSERT(!b->ImageIO(fn, "hex", false));
+    // Malformed files don't change the array.
+    ASSERT(b->ReadSingle(0).GetValue0() == 0x1a);
+    fp = fopen(fn, "w");
+    fprintf(fp, "12 34/56\n");
+    fclose(fp);
+    ASSERT(!b->ImageIO(fn, "hex", false));
+    // Values wider than 64 bits.
+    fp = fopen(fn, "w");
+    fprintf(fp, "123456789abcdef0fedcba987\n0000000000000000000000001\n");
+    fclose(fp);
+    iroha::NumericWidth w100;
+    w100.SetWidth(100);
+    std::unique_ptr<IntArray> wide(IntArray::Create(w100, s1));
+    ASSERT(wide->ImageIO(fn, "hex", false));
+    iroha::NumericValue v = wide->ReadSingle(0);
+    ASSERT(v.GetValue0() == 0xabcdef0fedcba987ULL);
+    iroha::NumericValue upper;
+    iroha::Op::SelectBits(v, w100, 99, 64, &upper, nullptr);
+    ASSERT(upper.GetValue0() == 0x123456789ULL);
+    ASSERT(wide->ReadSingle(1).GetValue0() == 1);
+    ASSERT(wide->ImageIO(fn, "hex", true));
+    std::unique_ptr<IntArray> wide2(IntArray::Create(w100, s1));
+    ASSERT(wide2->ImageIO(fn, "hex", false));
+    ASSERT(wide2->Equals(wide.get()));
+    fp = fopen(fn, "r");
+    char line[64];
+    ASSERT(fgets(line, sizeof(line), fp) != nullptr);
+    ASSERT(string(line) == "123456789abcdef0fedcba987\n");
+    fclose(fp);
+    unlink(fn);
+  }
+  {
+    // Bulk operations on packed arrays, across words and the end.
+    const int widths[] = {3, 8, 13, 64};
+    for (int w : widths) {
+      iroha::NumericWidth bw;
+      bw.SetWidth(w);
+      vector<uint64_t> s1;
+      s1.push_back(64);
+      std::unique_ptr<IntArray> p(IntArray::Create(bw, s1));
+      std::unique_ptr<IntArray> q(IntArray::Create(bw, s1));
+      iroha::NumericWidth t;
+      t.SetWidth(64);
+      iroha::NumericValue v;
+      for (int i = 0; i < 64; ++i) {
+	v.SetValue0(i * 0x1234567);
+	p->WriteSingle(i, t, v);
+      }
+      v.SetValue0(5);
+      q->Fill(60, 40, t, v);
+      for (int i = 0; i < 64; ++i) {
+	ASSERT(q->ReadSingle(i).GetValue0() == ((i >= 60 || i < 36) ? 5 : 0));
+      }
+      ASSERT(!q->Equals(p.get()));
+      q->CopyFrom(0, p.get(), 0, 64);
+      ASSERT(q->Equals(p.get()));
+      q->CopyFrom(61, p.get(), 7, 50);
+      for (int i = 0; i < 50; ++i) {
+	ASSERT(q->ReadSingle((61 + i) % 64).GetValue0() ==
+	       p->ReadSingle(7 + i).GetValue0());
+      }
+      // Overlapping copy in the same array.
+      std::unique_ptr<IntArray> r(IntArray::Copy(p.get()));
+      p->CopyFrom(3, p.get(), 1, 40);
+      ASSERT(p->ReadSingle(2).GetValue0() == r->ReadSingle(2).GetValue0());
+      for (int i = 0; i < 40; ++i) {
+	ASSERT(p->ReadSingle(3 + i).GetValue0() ==
+	       r->ReadSingle(1 + i).GetValue0());
+      }
+    }
+  }
 }
 
 }  // namespace vm
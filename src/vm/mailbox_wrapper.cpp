@@ -26,6 +26,8 @@ public:
 
   int width_;
   string name_;
+  // Guards the value and the waiters. Taken after the VM lock, if both.
+  std::mutex mu_;
   ThreadQueue put_waiters_;
   ThreadQueue get_waiters_;
   ThreadQueue notify_waiters_;
@@ -58,6 +60,8 @@ Annotation *MailboxWrapper::GetAnnotation(Object *obj) {
 }
 
 void MailboxWrapper::InstallMethods(VM *vm ,Object *obj, int width) {
+  // Wider values may be allocated by iroha, which is not thread safe.
+  bool thread_safe = (width <= 128);
   vector<RegisterType> rets;
   rets.push_back(NativeObjects::IntType(32));
   // width
@@ -65,27 +69,32 @@ void MailboxWrapper::InstallMethods(VM *vm ,Object *obj, int width) {
     NativeObjects::InstallNativeMethod(vm, obj, "width",
 				       &MailboxWrapper::Width, rets);
   m->SetSynthName(synth::kMailboxWidth);
+  m->SetIsThreadSafe(thread_safe);
   // put
   m = NativeObjects::InstallNativeMethod(vm, obj, "put",
 					 &MailboxWrapper::Put, rets);
   m->SetSynthName(synth::kMailboxPut);
+  m->SetIsThreadSafe(thread_safe);
   // notify
   m = NativeObjects::InstallNativeMethod(vm, obj, "notify",
 					 &MailboxWrapper::Notify, rets);
   m->SetSynthName(synth::kMailboxNotify);
+  m->SetIsThreadSafe(thread_safe);
   // get
   rets[0] = NativeObjects::IntType(width);
   m = NativeObjects::InstallNativeMethod(vm, obj, "get",
 					 &MailboxWrapper::Get, rets);
   m->SetSynthName(synth::kMailboxGet);
+  m->SetIsThreadSafe(thread_safe);
   // wait
   m = NativeObjects::InstallNativeMethod(vm, obj, "wait",
 					 &MailboxWrapper::Wait, rets);
   m->SetSynthName(synth::kMailboxWait);
+  m->SetIsThreadSafe(thread_safe);
 }
 
 void MailboxWrapper::Width(Thread *thr, Object *obj,
-			   const vector<Value> &args) {
+			   const ValueSpan &args) {
   Value value;
   value.type_ = Value::NUM;
   value.num_.SetValue0(GetWidth(obj));
@@ -93,55 +102,55 @@ void MailboxWrapper::Width(Thread *thr, Object *obj,
 }
 
 void MailboxWrapper::Get(Thread *thr, Object *obj,
-			 const vector<Value> &args) {
+			 const ValueSpan &args) {
   MailboxData *data = (MailboxData *)obj->object_specific_.get();
-  if (data->has_value_) {
-    data->has_value_ = false;
-    Value value;
-    value.type_ = Value::NUM;
-    value.num_ = data->number_;
-    thr->SetReturnValueFromNativeMethod(value);
-    WakeOne(true, data);
-  } else {
-    data->get_waiters_.AddThread(thr);
+  std::unique_lock<std::mutex> lock(data->mu_);
+  while (!data->has_value_) {
+    data->get_waiters_.Wait(thr, &lock);
   }
+  data->has_value_ = false;
+  Value value;
+  value.type_ = Value::NUM;
+  value.num_ = data->number_;
+  thr->SetReturnValueFromNativeMethod(value);
+  WakeOne(true, data);
 }
 
 void MailboxWrapper::Put(Thread *thr, Object *obj,
-			 const vector<Value> &args) {
+			 const ValueSpan &args) {
   MailboxData *data = (MailboxData *)obj->object_specific_.get();
-  if (data->has_value_) {
-    data->put_waiters_.AddThread(thr);
-  } else {
-    data->has_value_ = true;
-    data->number_ = args[0].num_;
-    WakeOne(false, data);
+  std::unique_lock<std::mutex> lock(data->mu_);
+  while (data->has_value_) {
+    data->put_waiters_.Wait(thr, &lock);
   }
+  data->has_value_ = true;
+  data->number_ = args[0].num_;
+  WakeOne(false, data);
 }
 
 void MailboxWrapper::Notify(Thread *thr, Object *obj,
-			    const vector<Value> &args) {
+			    const ValueSpan &args) {
   if (args.size() != 1 || args[0].type_ != Value::NUM) {
+    // Called without the VM lock.
+    std::lock_guard<VMLock> lock(thr->GetVM()->GetLock());
     Status::os(Status::USER_ERROR) << "Mailbox.write takes one value argument";
     thr->UserError();
     return;
   }
   MailboxData *data = (MailboxData *)obj->object_specific_.get();
+  std::lock_guard<std::mutex> lock(data->mu_);
   data->number_ = args[0].num_;
   data->notify_waiters_.ResumeAll();
 }
 
-void MailboxWrapper::Wait(Thread *thr, Object *obj, const vector<Value> &args) {
+void MailboxWrapper::Wait(Thread *thr, Object *obj, const ValueSpan &args) {
   MailboxData *data = (MailboxData *)obj->object_specific_.get();
-  if (data->notify_waiters_.ClearIfNotified(thr)) {
-    // Already notified at the same time (in execution event order).
-    Value value;
-    value.type_ = Value::NUM;
-    value.num_ = data->number_;
-    thr->SetReturnValueFromNativeMethod(value);
-  } else {
-    data->notify_waiters_.AddThread(thr);
-  }
+  std::unique_lock<std::mutex> lock(data->mu_);
+  data->notify_waiters_.Wait(thr, &lock);
+  Value value;
+  value.type_ = Value::NUM;
+  value.num_ = data->number_;
+  thr->SetReturnValueFromNativeMethod(value);
 }
 
 void MailboxWrapper::WakeOne(bool wake_put, MailboxData *data) {
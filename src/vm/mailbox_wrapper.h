@@ -18,11 +18,11 @@ public:
 
 private:
   static void InstallMethods(VM *vm ,Object *obj, int width);
-  static void Width(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Put(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Get(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Notify(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Wait(Thread *thr, Object *obj, const vector<Value> &args);
+  static void Width(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Put(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Get(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Notify(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Wait(Thread *thr, Object *obj, const ValueSpan &args);
 
   static void WakeOne(bool wake_put, MailboxData *data);
 };
@@ -0,0 +1,361 @@
+#include "vm/mem_image.h"
+
+#include "numeric/numeric_op.h"  // from iroha
+#include "vm/int_array.h"
+
+#include <fcntl.h>
+#include <functional>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace vm {
+
+namespace {
+
+// Smaller files (or blocks of values to save) are processed by one thread.
+const uint64_t kMinChunkBytes = 1024 * 1024;
+// Number of values formatted at once by Save().
+const uint64_t kSaveBlockValues = 1024 * 1024;
+
+struct Segment {
+  // Continues from the previous segment if false.
+  bool has_addr_;
+  uint64_t addr_;
+  // Each value has num_words words from the LSB.
+  vector<uint64_t> words_;
+};
+
+struct Chunk {
+  const char *begin_;
+  const char *end_;
+  vector<Segment> segments_;
+  bool ok_;
+};
+
+int NumThreads(uint64_t bytes) {
+  uint64_t n = std::thread::hardware_concurrency();
+  if (n > bytes / kMinChunkBytes) {
+    n = bytes / kMinChunkBytes;
+  }
+  if (n < 1) {
+    n = 1;
+  }
+  return n;
+}
+
+// Calls fn(0) ... fn(n - 1) in parallel.
+void RunParallel(int n, const std::function<void(int)> &fn) {
+  vector<std::thread> threads;
+  for (int i = 1; i < n; ++i) {
+    threads.emplace_back(fn, i);
+  }
+  fn(0);
+  for (std::thread &t : threads) {
+    t.join();
+  }
+}
+
+int BitsPerDigit(int radix) {
+  return (radix == 16) ? 4 : 1;
+}
+
+int NumWords(const iroha::NumericWidth &width) {
+  return (width.GetWidth() + 63) / 64;
+}
+
+// Values of digit characters. x and z are read as 0 and others are -1.
+struct DigitTable {
+  DigitTable() {
+    for (int i = 0; i < 256; ++i) {
+      values_[i] = -1;
+    }
+    for (int i = 0; i < 10; ++i) {
+      values_['0' + i] = i;
+    }
+    for (int i = 0; i < 6; ++i) {
+      values_['a' + i] = 10 + i;
+      values_['A' + i] = 10 + i;
+    }
+    values_['x'] = values_['X'] = values_['z'] = values_['Z'] = 0;
+  }
+
+  int8_t values_[256];
+};
+
+const DigitTable kDigitTable;
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' ||
+    c == '\v';
+}
+
+// Sets num_words words. Upper digits beyond them are ignored.
+bool ParseValue(const char *begin, const char *end, int radix, int num_words,
+		uint64_t *words) {
+  int bits_per_digit = BitsPerDigit(radix);
+  if (num_words == 1) {
+    uint64_t v = 0;
+    for (const char *p = begin; p < end; ++p) {
+      if (*p == '_') {
+	continue;
+      }
+      int d = kDigitTable.values_[(uint8_t)*p];
+      if (d < 0 || d >= radix) {
+	return false;
+      }
+      v = (v << bits_per_digit) | d;
+    }
+    words[0] = v;
+    return true;
+  }
+  for (int i = 0; i < num_words; ++i) {
+    words[i] = 0;
+  }
+  int max_bits = num_words * 64;
+  int bit = 0;
+  for (const char *p = end - 1; p >= begin; --p) {
+    if (*p == '_') {
+      continue;
+    }
+    int d = kDigitTable.values_[(uint8_t)*p];
+    if (d < 0 || d >= radix) {
+      return false;
+    }
+    if (bit < max_bits) {
+      words[bit / 64] |= ((uint64_t)d) << (bit % 64);
+    }
+    bit += bits_per_digit;
+  }
+  return true;
+}
+
+void WriteValue(IntArray *arr, uint64_t addr, const uint64_t *words,
+		int num_words) {
+  static const iroha::NumericWidth w64(false, 64);
+  iroha::Numeric n;
+  n.type_ = w64;
+  n.GetMutableArray()->SetValue0(words[num_words - 1]);
+  for (int i = num_words - 2; i >= 0; --i) {
+    iroha::NumericValue lower;
+    lower.SetValue0(words[i]);
+    iroha::Numeric t;
+    iroha::Op::Concat(n.GetArray(), n.type_, lower, w64,
+		      t.GetMutableArray(), &t.type_);
+    n = t;
+  }
+  arr->WriteSingle(addr, n.type_, n.GetArray());
+}
+
+// Keeps the values of a chunk until every chunk is parsed.
+class SegmentSink {
+public:
+  SegmentSink(Chunk *chunk) : chunk_(chunk) {
+    chunk_->segments_.resize(1);
+    chunk_->segments_[0].has_addr_ = false;
+    chunk_->segments_[0].addr_ = 0;
+  }
+
+  void SetAddress(uint64_t addr) {
+    Segment seg;
+    seg.has_addr_ = true;
+    seg.addr_ = addr;
+    chunk_->segments_.push_back(seg);
+  }
+  void Add(const uint64_t *words, int num_words) {
+    vector<uint64_t> &w = chunk_->segments_.back().words_;
+    w.insert(w.end(), words, words + num_words);
+  }
+
+private:
+  Chunk *chunk_;
+};
+
+template<class Sink>
+bool ParseChunk(const char *p, const char *end, int radix, int num_words,
+		Sink *sink) {
+  vector<uint64_t> words(num_words);
+  while (p < end) {
+    if (IsSpace(*p)) {
+      ++p;
+      continue;
+    }
+    if (*p == '/' && p + 1 < end && p[1] == '/') {
+      while (p < end && *p != '\n') {
+	++p;
+      }
+      continue;
+    }
+    if (*p == '/' && p + 1 < end && p[1] == '*') {
+      p += 2;
+      while (p + 1 < end && !(p[0] == '*' && p[1] == '/')) {
+	++p;
+      }
+      if (p + 1 >= end) {
+	return false;
+      }
+      p += 2;
+      continue;
+    }
+    const char *tok = p;
+    while (p < end && !IsSpace(*p) && *p != '/') {
+      ++p;
+    }
+    if (tok == p) {
+      // A '/' not starting a comment.
+      return false;
+    }
+    if (*tok == '@') {
+      uint64_t addr;
+      if (tok + 1 == p || !ParseValue(tok + 1, p, 16, 1, &addr)) {
+	return false;
+      }
+      sink->SetAddress(addr);
+      continue;
+    }
+    if (!ParseValue(tok, p, radix, num_words, &words[0])) {
+      return false;
+    }
+    sink->Add(&words[0], num_words);
+  }
+  return true;
+}
+
+void ReadValue(IntArray *arr, uint64_t addr, int num_words,
+	       uint64_t *words) {
+  const iroha::NumericWidth &w = arr->GetDataWidth();
+  iroha::NumericValue v = arr->ReadSingle(addr);
+  if (num_words == 1) {
+    uint64_t mask = (w.GetWidth() == 64) ? ~0ULL :
+      ((1ULL << w.GetWidth()) - 1);
+    words[0] = v.GetValue0() & mask;
+    return;
+  }
+  for (int i = 0; i < num_words; ++i) {
+    int h = std::min(i * 64 + 63, w.GetWidth() - 1);
+    iroha::NumericValue r;
+    iroha::NumericWidth rw;
+    iroha::Op::SelectBits(v, w, h, i * 64, &r, &rw);
+    words[i] = r.GetValue0();
+  }
+}
+
+void FormatValue(const uint64_t *words, int radix, int num_digits,
+		 char *buf) {
+  static const char kDigits[] = "0123456789abcdef";
+  int bits_per_digit = BitsPerDigit(radix);
+  for (int i = 0; i < num_digits; ++i) {
+    int bit = i * bits_per_digit;
+    int d = (words[bit / 64] >> (bit % 64)) & (radix - 1);
+    buf[num_digits - 1 - i] = kDigits[d];
+  }
+  buf[num_digits] = '\n';
+}
+
+}  // namespace
+
+bool MemImage::Load(const string &path, int radix, IntArray *arr) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  if (size == 0) {
+    close(fd);
+    return true;
+  }
+  void *m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED) {
+    return false;
+  }
+  const char *data = (const char *)m;
+  const char *data_end = data + size;
+  int num_words = NumWords(arr->GetDataWidth());
+  // Chunks are split at new lines, so a block comment may span them.
+  int n = 1;
+  if (memmem(data, size, "/*", 2) == nullptr) {
+    n = NumThreads(size);
+  }
+  vector<Chunk> chunks(n);
+  for (int i = 0; i < n; ++i) {
+    Chunk &c = chunks[i];
+    c.begin_ = (i == 0) ? data : chunks[i - 1].end_;
+    const char *e = std::max(c.begin_, data + size * (i + 1) / n);
+    while (e < data_end && e > data && e[-1] != '\n') {
+      ++e;
+    }
+    c.end_ = (i == n - 1) ? data_end : e;
+  }
+  RunParallel(n, [&chunks, radix, num_words](int i) {
+      Chunk &c = chunks[i];
+      SegmentSink sink(&c);
+      c.ok_ = ParseChunk(c.begin_, c.end_, radix, num_words, &sink);
+    });
+  bool ok = true;
+  for (Chunk &c : chunks) {
+    ok &= c.ok_;
+  }
+  // Writes serially, since arrays are not thread safe. Nothing is written
+  // if any chunk is malformed.
+  uint64_t addr = 0;
+  for (int i = 0; ok && i < n; ++i) {
+    for (Segment &seg : chunks[i].segments_) {
+      if (seg.has_addr_) {
+	addr = seg.addr_;
+      }
+      for (size_t j = 0; j < seg.words_.size(); j += num_words) {
+	WriteValue(arr, addr, &seg.words_[j], num_words);
+	++addr;
+      }
+    }
+  }
+  munmap(m, size);
+  return ok;
+}
+
+bool MemImage::Save(const string &path, int radix, IntArray *arr) {
+  FILE *fp = fopen(path.c_str(), "w");
+  if (fp == nullptr) {
+    return false;
+  }
+  const iroha::NumericWidth &w = arr->GetDataWidth();
+  int num_words = NumWords(w);
+  int bits_per_digit = BitsPerDigit(radix);
+  int num_digits = (w.GetWidth() + bits_per_digit - 1) / bits_per_digit;
+  int line_bytes = num_digits + 1;
+  uint64_t length = arr->GetLength();
+  vector<uint64_t> words;
+  vector<char> buf;
+  bool ok = true;
+  for (uint64_t start = 0; ok && start < length; start += kSaveBlockValues) {
+    uint64_t count = std::min(kSaveBlockValues, length - start);
+    words.resize(count * num_words);
+    for (uint64_t i = 0; i < count; ++i) {
+      ReadValue(arr, start + i, num_words, &words[i * num_words]);
+    }
+    buf.resize(count * line_bytes);
+    int n = NumThreads(buf.size());
+    RunParallel(n, [&words, &buf, count, n, num_words, radix, num_digits,
+		    line_bytes](int t) {
+		  uint64_t b = count * t / n;
+		  uint64_t e = count * (t + 1) / n;
+		  for (uint64_t i = b; i < e; ++i) {
+		    FormatValue(&words[i * num_words], radix, num_digits,
+				&buf[i * line_bytes]);
+		  }
+		});
+    ok = (fwrite(&buf[0], buf.size(), 1, fp) == 1);
+  }
+  fclose(fp);
+  return ok;
+}
+
+}  // namespace vm
@@ -0,0 +1,24 @@
+// -*- C++ -*-
+#ifndef _vm_mem_image_h_
+#define _vm_mem_image_h_
+
+#include "vm/common.h"
+
+namespace vm {
+
+// Text images compatible with $readmemh and $readmemb of Verilog.
+// Values are separated by white spaces and comments. "@addr" (in hex)
+// sets the address of the next value. Values can be wider than 64 bits.
+// Large files are parsed in chunks on multiple OS threads.
+class MemImage {
+public:
+  // radix is 16 ($readmemh) or 2 ($readmemb). The array is kept as is if
+  // the file is malformed.
+  static bool Load(const string &path, int radix, IntArray *arr);
+  // Writes one value per line with leading zeros.
+  static bool Save(const string &path, int radix, IntArray *arr);
+};
+
+}  // namespace vm
+
+#endif  // _vm_mem_image_h_
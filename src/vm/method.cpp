@@ -11,7 +11,7 @@ namespace vm {
 
 Method::Method(bool is_toplevel) :
   is_toplevel_(is_toplevel), method_fn_(nullptr), parse_tree_(nullptr),
-  alt_impl_(nullptr), compile_failed_(false) {
+  alt_impl_(nullptr), compile_failed_(false), is_thread_safe_(false) {
 }
 
 Method::~Method() {
@@ -73,6 +73,14 @@ void Method::SetSynthName(const string &s) {
   synth_name_ = s;
 }
 
+bool Method::IsThreadSafe() const {
+  return is_thread_safe_;
+}
+
+void Method::SetIsThreadSafe(bool b) {
+  is_thread_safe_ = b;
+}
+
 bool Method::IsTopLevel() const {
   return is_toplevel_;
 }
@@ -140,4 +148,15 @@ bool Method::IsThreadEntry() const {
   return false;
 }
 
+void Method::BuildRegValuesTemplate() {
+  reg_values_template_.resize(method_regs_.size());
+  for (size_t i = 0; i < method_regs_.size(); ++i) {
+    Value &value = reg_values_template_[i];
+    Register *reg = method_regs_[i];
+    value.type_ = reg->type_.value_type_;
+    value.enum_val_.enum_type = reg->type_.enum_type_;
+    value.num_type_ = reg->type_.width_;
+  }
+}
+
 }  // namespace vm
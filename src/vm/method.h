@@ -3,6 +3,7 @@
 #define _vm_method_h_
 
 #include "vm/common.h"
+#include "vm/insn.h"  // for DecodedInsn
 #include "vm/register.h"  // for RegisterType
 
 namespace vm {
@@ -14,7 +15,7 @@ public:
   ~Method();
 
   typedef void (*method_func)(Thread *thr, Object *obj,
-			      const vector<Value> &args);
+			      const ValueSpan &args);
 
   void Dump() const;
   void Dump(DumpStream &os) const;
@@ -35,11 +36,22 @@ public:
   void SetCompileFailure();
   bool IsCompileFailure() const;
   bool IsThreadEntry() const;
+  // Native methods synchronizing by themselves run without the VM lock
+  // (--workers).
+  bool IsThreadSafe() const;
+  void SetIsThreadSafe(bool b);
+  // Builds reg_values_template_ from method_regs_.
+  void BuildRegValuesTemplate();
 
   vector<Insn*> insns_;
+  // Same length as insns_ after the compilation.
+  vector<DecodedInsn> decoded_insns_;
   // Args. Returns. Locals.
   vector<Register*> method_regs_;
   vector<RegisterType> return_types_;
+  // Initial values of a MethodFrame to be copied on each call.
+  // Built after the compilation of non top level methods.
+  vector<Value> reg_values_template_;
 
 private:
   bool is_toplevel_;
@@ -50,6 +62,7 @@ private:
   const char *alt_impl_;
   string synth_name_;
   bool compile_failed_;
+  bool is_thread_safe_;
 };
 
 }  // namespace vm
@@ -1,5 +1,6 @@
 #include "vm/native_methods.h"
 
+#include <atomic>
 #include <stdlib.h>
 
 #include "base/pool.h"
@@ -10,6 +11,7 @@
 #include "synth/synth.h"
 #include "synth/object_attr_names.h"
 #include "synth/object_method_names.h"
+#include "vm/gc.h"
 #include "vm/method.h"
 #include "vm/object.h"
 #include "vm/object_util.h"
@@ -22,8 +24,11 @@
 
 namespace vm {
 
+// Threads may run on --workers.
+static std::atomic<int> num_assertion_failures(0);
+
 void NativeMethods::Assert(Thread *thr, Object *obj,
-			   const vector<Value> &args) {
+			   const ValueSpan &args) {
   CHECK(args.size() == 1) << "Assert got " << args.size() << "args.";
   const Value &arg = args[0];
   VM *vm = thr->GetVM();
@@ -31,11 +36,16 @@ void NativeMethods::Assert(Thread *thr, Object *obj,
   CHECK(arg.enum_val_.enum_type == vm->bool_type_);
   if (arg.enum_val_.val == 0) {
     cout << "ASSERTION FAILURE\n";
+    ++num_assertion_failures;
   }
 }
 
+int NativeMethods::GetNumAssertionFailures() {
+  return num_assertion_failures;
+}
+
 void NativeMethods::Clone(Thread *thr, Object *obj,
-			  const vector<Value> &args) {
+			  const ValueSpan &args) {
   Value value;
   value.type_ = Value::OBJECT;
   value.object_ = obj->Clone();
@@ -43,17 +53,17 @@ void NativeMethods::Clone(Thread *thr, Object *obj,
 }
 
 void NativeMethods::Dump(Thread *thr, Object *obj,
-			 const vector<Value> &args) {
+			 const ValueSpan &args) {
   obj->Dump();
 }
 
 void NativeMethods::Exit(Thread *thr, Object *obj,
-			 const vector<Value> &args) {
+			 const ValueSpan &args) {
   thr->Exit();
 }
 
 void NativeMethods::GetTickCount(Thread *thr, Object *obj,
-				 const vector<Value> &args) {
+				 const ValueSpan &args) {
   Value value;
   value.type_ = Value::NUM;
   iroha::Op::MakeConst0(thr->GetVM()->GetTickCount(), &value.num_);
@@ -61,12 +71,12 @@ void NativeMethods::GetTickCount(Thread *thr, Object *obj,
 }
 
 void NativeMethods::Main(Thread *thr, Object *obj,
-			 const vector<Value> &args) {
+			 const ValueSpan &args) {
   // do nothing.
 }
 
 void NativeMethods::New(Thread *thr, Object *obj,
-			const vector<Value> &args) {
+			const ValueSpan &args) {
   // Saved in default-isynth.karuta
   Value *v = thr->GetVM()->kernel_object_
     ->LookupValue(sym_lookup("Kernel_"), true);
@@ -77,7 +87,7 @@ void NativeMethods::New(Thread *thr, Object *obj,
 }
 
 void NativeMethods::Print(Thread *thr, Object *obj,
-			  const vector<Value> &args) {
+			  const ValueSpan &args) {
   cout << "print: ";
   for (size_t i = 0; i < args.size(); ++i) {
     args[i].Dump(cout);
@@ -87,12 +97,12 @@ void NativeMethods::Print(Thread *thr, Object *obj,
 
 
 void NativeMethods::Run(Thread *thr, Object *obj,
-			const vector<Value> &args) {
+			const ValueSpan &args) {
   ThreadWrapper::Run(thr->GetVM(), obj);
 }
 
 void NativeMethods::SetAddressWidth(Thread *thr, Object *obj,
-				    const vector<Value> &args) {
+				    const ValueSpan &args) {
   if (args.size() != 1 || args[0].type_ != Value::NUM) {
     Status::os(Status::USER_ERROR) << "Only 1 int argument is allowed";
     thr->UserError();
@@ -108,17 +118,17 @@ void NativeMethods::SetAddressWidth(Thread *thr, Object *obj,
 }
 
 void NativeMethods::SetDump(Thread *thr, Object *obj,
-			    const vector<Value> &args) {
+			    const ValueSpan &args) {
   SetMemberString(thr, synth::kDumpFileName, obj, args);
 }
 
 void NativeMethods::SetIROutput(Thread *thr, Object *obj,
-				const vector<Value> &args) {
+				const ValueSpan &args) {
   SetMemberString(thr, synth::kIrFileName, obj, args);
 }
 
 void NativeMethods::SetIrohaPath(Thread *thr, Object *obj,
-				 const vector<Value> &args) {
+				 const ValueSpan &args) {
   if (Env::IsSandboxMode()) {
     Status::os(Status::USER_ERROR)
       << "SetIrohaPath() is not allowed on sandbox mode";
@@ -129,7 +139,7 @@ void NativeMethods::SetIrohaPath(Thread *thr, Object *obj,
 }
 
 void NativeMethods::RunIroha(Thread *thr, Object *obj,
-			     const vector<Value> &args) {
+			     const ValueSpan &args) {
   if (Env::IsSandboxMode()) {
     Status::os(Status::USER_ERROR)
       << "RunIroha() is not allowed on sandbox mode";
@@ -151,7 +161,7 @@ void NativeMethods::RunIroha(Thread *thr, Object *obj,
 }
 
 void NativeMethods::Synth(Thread *thr, Object *obj,
-			   const vector<Value> &args) {
+			   const ValueSpan &args) {
   if (args.size() != 1 || args[0].type_ != Value::OBJECT ||
       !StringWrapper::IsString(args[0].object_)) {
   }
@@ -161,7 +171,7 @@ void NativeMethods::Synth(Thread *thr, Object *obj,
 
 void NativeMethods::SetMemberString(Thread *thr, const char *name,
 				    Object *obj,
-				    const vector<Value> &args) {
+				    const ValueSpan &args) {
   if (args.size() == 1 && args[0].type_ == Value::OBJECT &&
       StringWrapper::IsString(args[0].object_)) {
     const string &str = StringWrapper::String(args[0].object_);
@@ -170,7 +180,7 @@ void NativeMethods::SetMemberString(Thread *thr, const char *name,
 }
 
 void NativeMethods::Compile(Thread *thr, Object *obj,
-			    const vector<Value> &args) {
+			    const ValueSpan &args) {
   string phase;
   if (args.size() == 1) {
     CHECK(StringWrapper::IsString(args[0].object_));
@@ -193,7 +203,7 @@ void NativeMethods::Compile(Thread *thr, Object *obj,
 }
 
 void NativeMethods::SetSynthParam(Thread *thr, Object *obj,
-				  const vector<Value> &args) {
+				  const ValueSpan &args) {
   if (args.size() != 2 ||
       (args[0].type_ != Value::OBJECT ||
        !StringWrapper::IsString(args[0].object_))) {
@@ -225,7 +235,7 @@ void NativeMethods::SetSynthParam(Thread *thr, Object *obj,
 }
 
 void NativeMethods::WidthOf(Thread *thr, Object *obj,
-			    const vector<Value> &args) {
+			    const ValueSpan &args) {
   if (args.size() != 1 || args[0].type_ != Value::NUM) {
     Status::os(Status::USER_ERROR) << "Invalid argument to widthof()";
     MessageFlush::Get(Status::USER_ERROR);
@@ -240,11 +250,16 @@ void NativeMethods::WidthOf(Thread *thr, Object *obj,
 }
 
 void NativeMethods::Wait(Thread *thr, Object *obj,
-			 const vector<Value> &args) {
+			 const ValueSpan &args) {
+  uint64_t cycles = 1;
+  if (args.size() > 0 && args[0].type_ == Value::NUM) {
+    cycles = args[0].num_.GetValue0();
+  }
+  thr->Wait(cycles);
 }
 
 void NativeMethods::WriteHdl(Thread *thr, Object *obj,
-			     const vector<Value> &args) {
+			     const ValueSpan &args) {
   CHECK(args.size() == 1);
   const Value& arg = args[0];
   CHECK(StringWrapper::IsString(arg.object_));
@@ -252,12 +267,12 @@ void NativeMethods::WriteHdl(Thread *thr, Object *obj,
 }
 
 void NativeMethods::Yield(Thread *thr, Object *obj,
-			  const vector<Value> &args) {
+			  const ValueSpan &args) {
   thr->Yield();
 }
 
 void NativeMethods::IsMain(Thread *thr, Object *obj,
-			   const vector<Value> &args) {
+			   const ValueSpan &args) {
   Value value;
   value.type_ = Value::ENUM_ITEM;
   value.enum_val_.enum_type = thr->GetVM()->bool_type_;
@@ -265,23 +280,54 @@ void NativeMethods::IsMain(Thread *thr, Object *obj,
   SetReturnValue(thr, value);
 }
 
+static void Collect(Thread *thr, bool full) {
+  vm::GC *gc = thr->GetVM()->GetGC();
+  if (thr->GetVM()->IsParallel()) {
+    // Other threads may be in thread safe native methods. Collects after
+    // this round.
+    gc->Request(full);
+  } else {
+    gc->Collect(full);
+  }
+}
+
 void NativeMethods::GC(Thread *thr, Object *obj,
-		       const vector<Value> &args) {
-  thr->GetVM()->GC();
+		       const ValueSpan &args) {
+  Collect(thr, true);
+}
+
+void NativeMethods::MinorGC(Thread *thr, Object *obj,
+			    const ValueSpan &args) {
+  Collect(thr, false);
+}
+
+void NativeMethods::GCCount(Thread *thr, Object *obj,
+			    const ValueSpan &args) {
+  SetReturnNum(thr, thr->GetVM()->GetGC()->GetNumCollections());
+}
+
+void NativeMethods::GCPauseUsec(Thread *thr, Object *obj,
+				const ValueSpan &args) {
+  SetReturnNum(thr, thr->GetVM()->GetGC()->GetTotalPauseUsec());
+}
+
+void NativeMethods::GCMaxPauseUsec(Thread *thr, Object *obj,
+				   const ValueSpan &args) {
+  SetReturnNum(thr, thr->GetVM()->GetGC()->GetMaxPauseUsec());
 }
 
 void NativeMethods::ClearProfile(Thread *thr, Object *obj,
-				 const vector<Value> &args) {
+				 const ValueSpan &args) {
   thr->GetVM()->GetProfile()->Clear();
 }
 
 void NativeMethods::EnableProfile(Thread *thr, Object *obj,
-				  const vector<Value> &args) {
+				  const ValueSpan &args) {
   thr->GetVM()->GetProfile()->SetEnable(true);
 }
 
 void NativeMethods::DisableProfile(Thread *thr, Object *obj,
-				   const vector<Value> &args) {
+				   const ValueSpan &args) {
   thr->GetVM()->GetProfile()->SetEnable(false);
 }
 
@@ -289,4 +335,11 @@ void NativeMethods::SetReturnValue(Thread *thr, const Value &value) {
   thr->SetReturnValueFromNativeMethod(value);
 }
 
+void NativeMethods::SetReturnNum(Thread *thr, uint64_t num) {
+  Value value;
+  value.type_ = Value::NUM;
+  iroha::Op::MakeConst0(num, &value.num_);
+  SetReturnValue(thr, value);
+}
+
 }  // namespace vm
@@ -10,44 +10,52 @@ namespace vm {
 class NativeMethods {
 public:
   // Kernel.
-  static void Assert(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Clone(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Channel(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Compile(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Dump(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Exit(Thread *thr, Object *obj, const vector<Value> &args);
-  static void GetTickCount(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Print(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Run(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Main(Thread *thr, Object *obj, const vector<Value> &args);
-  static void New(Thread *thr, Object *obj, const vector<Value> &args);
+  static void Assert(Thread *thr, Object *obj, const ValueSpan &args);
+  // Failed assert() calls so far in this process.
+  static int GetNumAssertionFailures();
+  static void Clone(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Channel(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Compile(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Dump(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Exit(Thread *thr, Object *obj, const ValueSpan &args);
+  static void GetTickCount(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Print(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Run(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Main(Thread *thr, Object *obj, const ValueSpan &args);
+  static void New(Thread *thr, Object *obj, const ValueSpan &args);
   static void SetAddressWidth(Thread *thr, Object *obj,
-			      const vector<Value> &args);
-  static void SetDump(Thread *thr, Object *obj, const vector<Value> &args);
+			      const ValueSpan &args);
+  static void SetDump(Thread *thr, Object *obj, const ValueSpan &args);
   static void SetSynthParam(Thread *thr, Object *obj,
-			    const vector<Value> &args);
-  static void Wait(Thread *thr, Object *obj, const vector<Value> &args);
-  static void WidthOf(Thread *thr, Object *obj, const vector<Value> &args);
-  static void WriteHdl(Thread *thr, Object *obj, const vector<Value> &args);
-  static void Yield(Thread *thr, Object *obj, const vector<Value> &args);
+			    const ValueSpan &args);
+  static void Wait(Thread *thr, Object *obj, const ValueSpan &args);
+  static void WidthOf(Thread *thr, Object *obj, const ValueSpan &args);
+  static void WriteHdl(Thread *thr, Object *obj, const ValueSpan &args);
+  static void Yield(Thread *thr, Object *obj, const ValueSpan &args);
 
   // Iroha.
-  static void SetIROutput(Thread *thr, Object *obj, const vector<Value> &arg);
-  static void SetIrohaPath(Thread *thr, Object *obj, const vector<Value> &arg);
-  static void RunIroha(Thread *thr, Object *obj, const vector<Value> &arg);
-  static void Synth(Thread *thr, Object *obj, const vector<Value> &arg);
+  static void SetIROutput(Thread *thr, Object *obj, const ValueSpan &arg);
+  static void SetIrohaPath(Thread *thr, Object *obj, const ValueSpan &arg);
+  static void RunIroha(Thread *thr, Object *obj, const ValueSpan &arg);
+  static void Synth(Thread *thr, Object *obj, const ValueSpan &arg);
 
   // Env.
-  static void IsMain(Thread *thr, Object *obj, const vector<Value> &args);
-  static void GC(Thread *thr, Object *obj, const vector<Value> &args);
-  static void ClearProfile(Thread *thr, Object *obj, const vector<Value> &args);
-  static void EnableProfile(Thread *thr, Object *obj, const vector<Value> &args);
-  static void DisableProfile(Thread *thr, Object *obj, const vector<Value> &args);
+  static void IsMain(Thread *thr, Object *obj, const ValueSpan &args);
+  static void GC(Thread *thr, Object *obj, const ValueSpan &args);
+  static void MinorGC(Thread *thr, Object *obj, const ValueSpan &args);
+  static void GCCount(Thread *thr, Object *obj, const ValueSpan &args);
+  static void GCPauseUsec(Thread *thr, Object *obj, const ValueSpan &args);
+  static void GCMaxPauseUsec(Thread *thr, Object *obj,
+			     const ValueSpan &args);
+  static void ClearProfile(Thread *thr, Object *obj, const ValueSpan &args);
+  static void EnableProfile(Thread *thr, Object *obj, const ValueSpan &args);
+  static void DisableProfile(Thread *thr, Object *obj, const ValueSpan &args);
 
   static void SetReturnValue(Thread *thr, const Value &value);
+  static void SetReturnNum(Thread *thr, uint64_t num);
   static void SetMemberString(Thread *thr, const char *name,
 			      Object *obj,
-			      const vector<Value> &args);
+			      const ValueSpan &args);
 };
 
 }  // namespace vm
@@ -82,6 +82,7 @@ Method *NativeObjects::InstallNativeMethod(VM *vm, Object *obj,
 void NativeObjects::InstallEnvNativeMethods(VM *vm, Object *env) {
   vector<RegisterType> rets;
   InstallNativeMethod(vm, env, "gc", &NativeMethods::GC, rets);
+  InstallNativeMethod(vm, env, "minorGc", &NativeMethods::MinorGC, rets);
   InstallNativeMethod(vm, env, "clearProfile",
 		      &NativeMethods::ClearProfile, rets);
   InstallNativeMethod(vm, env, "enableProfile",
@@ -90,6 +91,13 @@ void NativeObjects::InstallEnvNativeMethods(VM *vm, Object *env) {
 		      &NativeMethods::DisableProfile, rets);
   rets.push_back(BoolType(vm));
   InstallNativeMethod(vm, env, "isMain", &NativeMethods::IsMain, rets);
+  rets.clear();
+  rets.push_back(IntType(32));
+  InstallNativeMethod(vm, env, "gcCount", &NativeMethods::GCCount, rets);
+  InstallNativeMethod(vm, env, "gcPauseUsec", &NativeMethods::GCPauseUsec,
+		      rets);
+  InstallNativeMethod(vm, env, "gcMaxPauseUsec",
+		      &NativeMethods::GCMaxPauseUsec, rets);
 }
 
 RegisterType NativeObjects::ObjectType() {
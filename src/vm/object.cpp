@@ -2,6 +2,8 @@
 
 #include "base/dump_stream.h"
 #include "karuta/annotation.h"
+#include "vm/arena.h"
+#include "vm/gc.h"
 #include "vm/array_wrapper.h"
 #include "vm/int_array.h"
 #include "vm/object_util.h"
@@ -14,6 +16,14 @@ namespace vm {
 ObjectSpecificData::~ObjectSpecificData() {
 }
 
+void *ObjectSpecificData::operator new(size_t size) {
+  return SlabAllocator::AllocateData(size);
+}
+
+void ObjectSpecificData::operator delete(void *p, size_t size) {
+  SlabAllocator::FreeData(p, size);
+}
+
 const char *ObjectSpecificData::ObjectTypeKey() {
   return nullptr;
 }
@@ -26,7 +36,10 @@ void Object::Dump() {
   Dump(ds);
 }
 
-Object::Object(VM *vm) : vm_(vm) {
+Object::Object(VM *vm)
+  : gc_marked_(false), gc_old_(false), gc_remembered_(false),
+    gc_next_(nullptr), vm_(vm),
+    shape_(vm->GetRootShape()) {
 }
 
 const char *Object::ObjectTypeKey() {
@@ -41,10 +54,10 @@ void Object::Dump(DumpStream &ds) {
 	<< std::hex << (unsigned long)this
 	<< std::dec << "\n";
   ds.push_indent();
-  for (const std::pair<sym_t, Value> &it : members_) {
+  for (size_t i = 0; i < slots_.size(); ++i) {
     ds.indent();
-    ds.os << sym_cstr(it.first) << ":";
-    it.second.Dump(ds.os);
+    ds.os << sym_cstr(shape_->GetName(i)) << ":";
+    slots_[i].Dump(ds.os);
     ds.os << "\n";
   }
   ds.pop_indent();
@@ -55,44 +68,61 @@ VM *Object::GetVM() {
 }
 
 void Object::InstallValue(sym_t name, const Value &value) {
-  members_.insert(std::make_pair(name, value));
+  if (shape_->GetIndex(name) >= 0) {
+    return;
+  }
+  WriteBarrier();
+  shape_ = shape_->AddMember(name);
+  slots_.push_back(value);
 }
 
 Value *Object::LookupValue(sym_t name, bool cr) {
-  map<sym_t, Value>::iterator it = members_.find(name);
-  if (it != members_.end()) {
-    return &it->second;
+  WriteBarrier();
+  int index = shape_->GetIndex(name);
+  if (index >= 0) {
+    return &slots_[index];
   }
   if (!cr) {
     return nullptr;
   }
-  return &(members_[name]);
+  shape_ = shape_->AddMember(name);
+  slots_.push_back(Value());
+  return &slots_.back();
+}
+
+void Object::RemoveValue(sym_t name) {
+  int index = shape_->GetIndex(name);
+  if (index < 0) {
+    return;
+  }
+  shape_ = shape_->RemoveMember(name);
+  slots_.erase(slots_.begin() + index);
 }
 
 void Object::LookupMemberNames(Object *obj, vector<sym_t> *slots) {
-  for (auto it : members_) {
-    Value &value = it.second;
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    Value &value = slots_[i];
     // Can be object, array, string or other wrapped type.
     if (value.object_ == obj) {
-      slots->push_back(it.first);
+      slots->push_back(shape_->GetName(i));
     }
   }
 }
 
 void Object::GetAllMemberObjs(map<sym_t, Object *> *member_objs) {
-  for (auto it : members_) {
-    Value &value = it.second;
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    Value &value = slots_[i];
     if (value.IsObjectType()) {
-      (*member_objs)[it.first] = value.object_;
+      (*member_objs)[shape_->GetName(i)] = value.object_;
     }
   }
 }
 
 void Object::GetAllMemberMethods(map<sym_t, Method *> *member_objs) {
-  for (auto it : members_) {
-    Value &value = it.second;
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    Value &value = slots_[i];
     if (value.type_ == Value::METHOD) {
-      (*member_objs)[it.first] = value.method_;
+      (*member_objs)[shape_->GetName(i)] = value.method_;
     }
   }
 }
@@ -100,9 +130,10 @@ void Object::GetAllMemberMethods(map<sym_t, Method *> *member_objs) {
 Object *Object::Clone() {
   Object *new_obj = vm_->NewEmptyObject();
   // This does shallow copy for most of data types.
-  new_obj->members_ = members_;
-  for (auto it : new_obj->members_) {
-    Value &value = it.second;
+  new_obj->shape_ = shape_;
+  new_obj->slots_ = slots_;
+  vm_->GetGC()->AddBytes(slots_.size() * sizeof(Value));
+  for (auto value : new_obj->slots_) {
     if (value.type_ == Value::INT_ARRAY) {
       value.object_ = ArrayWrapper::Copy(vm_, value.object_);
     }
@@ -123,6 +154,14 @@ Object *Object::Clone() {
   return new_obj;
 }
 
+size_t Object::GetSize() const {
+  return sizeof(Object) + slots_.capacity() * sizeof(Value);
+}
+
+void Object::Remember() {
+  vm_->GetGC()->Remember(this);
+}
+
 const string &Object::ToString() {
   if (StringWrapper::IsString(this)) {
     return StringWrapper::String(this);
@@ -146,6 +185,9 @@ bool Object::Compare(Object *obj) {
 }
 
 void Object::Scan(GC *gc) {
+  for (const Value &value : slots_) {
+    gc->MarkValue(value);
+  }
   auto *od = object_specific_.get();
   if (od != nullptr) {
     od->Scan(gc);
@@ -3,17 +3,17 @@
 #define _vm_object_h_
 
 #include "vm/common.h"
+#include "vm/shape.h"
 #include "vm/value.h"
 
-#include <map>
-
-using std::map;
-
 namespace vm {
 
 class ObjectSpecificData {
 public:
   virtual ~ObjectSpecificData();
+  // Allocated from the slabs of the size class.
+  static void *operator new(size_t size);
+  static void operator delete(void *p, size_t size);
   virtual bool Compare(Object *obj) { return false; };
   virtual const char *ObjectTypeKey();
   virtual void Scan(GC *gc);
@@ -30,7 +30,18 @@ public:
 
   VM *GetVM();
   void InstallValue(sym_t name, const Value &value);
+  // Returned pointer is valid until a member is added or removed.
+  // The caller may modify the value, so this calls WriteBarrier().
   Value *LookupValue(sym_t name, bool cr);
+  void RemoveValue(sym_t name);
+  // Members are stored in the slots in the order of the shape.
+  const Shape *GetShape() const { return shape_; }
+  int GetNumMembers() const { return slots_.size(); }
+  sym_t GetMemberName(int index) const { return shape_->GetName(index); }
+  Value &GetMemberValue(int index) {
+    WriteBarrier();
+    return slots_[index];
+  }
   // Finds synonyms of specified member object.
   void LookupMemberNames(Object *obj, vector<sym_t> *slots);
   void GetAllMemberObjs(map<sym_t, Object *> *member_objs);
@@ -38,15 +49,33 @@ public:
   Object *Clone();
   const string &ToString();
   bool Compare(Object *obj);
-  // Object type specific GC hook.
+  // Marks the referenced objects.
   void Scan(GC *gc);
-
-  map<sym_t, Value> members_;
+  // Estimated bytes used by this object.
+  size_t GetSize() const;
+  // Should be called before a reference in this object is modified, so
+  // that the young objects referenced from old ones are found.
+  void WriteBarrier() {
+    if (gc_old_ && !gc_remembered_) {
+      Remember();
+    }
+  }
 
   std::unique_ptr<ObjectSpecificData> object_specific_;
 
+  // GC states.
+  bool gc_marked_;
+  bool gc_old_;
+  bool gc_remembered_;
+  // Next young object.
+  Object *gc_next_;
+
 private:
+  void Remember();
+
   VM *vm_;
+  Shape *shape_;
+  vector<Value> slots_;
 };
 
 }  // namespace vm
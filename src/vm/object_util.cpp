@@ -21,6 +21,14 @@ void ObjectUtil::SetAddressWidth(Object *obj, int width) {
   iroha::Op::MakeConst0(width, &value->num_);
 }
 
+void ObjectUtil::SetIntMember(Object *obj, const string &key,
+			      uint64_t val) {
+  Value *value = obj->LookupValue(sym_lookup(key.c_str()), true);
+  value->type_ = Value::NUM;
+  value->num_type_ = iroha::NumericWidth(false, 32);
+  iroha::Op::MakeConst0(val, &value->num_);
+}
+
 string ObjectUtil::GetStringMember(Object *obj, const string &key) {
   Value *value = obj->LookupValue(sym_lookup(key.c_str()), false);
   if (value == nullptr || value->type_ != Value::OBJECT ||
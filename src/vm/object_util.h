@@ -10,6 +10,7 @@ class ObjectUtil {
 public:
   static int GetAddressWidth(Object *obj);
   static void SetAddressWidth(Object *obj, int width);
+  static void SetIntMember(Object *obj, const string &key, uint64_t val);
   static string GetStringMember(Object *obj, const string &key);
   static void SetStringMember(Object *obj, const string &key,
 			      const string &str);
@@ -0,0 +1,54 @@
+#include "vm/shape.h"
+
+namespace vm {
+
+Shape::Shape()
+  : root_(this), parent_(nullptr), num_slots_(0), table_(new Table()) {
+}
+
+Shape::Shape(Shape *root, Shape *parent, sym_t name)
+  : root_(root), parent_(parent), num_slots_(parent->num_slots_ + 1) {
+  if (parent->table_->names_.size() == parent->num_slots_) {
+    table_ = parent->table_;
+  } else {
+    // Branches from the middle of the chain.
+    table_.reset(new Table());
+    table_->names_.assign(parent->table_->names_.begin(),
+			  parent->table_->names_.begin() + parent->num_slots_);
+    for (int i = 0; i < parent->num_slots_; ++i) {
+      table_->indexes_[table_->names_[i]] = i;
+    }
+  }
+  table_->indexes_[name] = parent->num_slots_;
+  table_->names_.push_back(name);
+}
+
+Shape::~Shape() {
+}
+
+Shape *Shape::AddMember(sym_t name) {
+  CHECK(GetIndex(name) < 0);
+  std::unique_ptr<Shape> &next = transitions_[name];
+  if (next.get() == nullptr) {
+    next.reset(new Shape(root_, this, name));
+  }
+  return next.get();
+}
+
+Shape *Shape::RemoveMember(sym_t name) {
+  int index = GetIndex(name);
+  if (index < 0) {
+    return this;
+  }
+  // Adds the members after name to the shape before it.
+  Shape *shape = this;
+  while (shape->num_slots_ > index) {
+    shape = shape->parent_;
+  }
+  for (int i = index + 1; i < num_slots_; ++i) {
+    shape = shape->AddMember(GetName(i));
+  }
+  return shape;
+}
+
+}  // namespace vm
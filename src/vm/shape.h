@@ -0,0 +1,59 @@
+// -*- C++ -*-
+#ifndef _vm_shape_h_
+#define _vm_shape_h_
+
+#include "vm/common.h"
+
+#include <map>
+
+using std::map;
+
+namespace vm {
+
+// Layout of members shared by objects with the same member set.
+// A Shape maps member names to indexes of the slots in Object.
+// Shapes are immutable and form a transition tree from the root
+// (empty) shape, so objects built in the same way share a Shape.
+class Shape {
+public:
+  // Creates a root shape. The root owns all the derived shapes.
+  Shape();
+  ~Shape();
+
+  // Returns -1 if the name is not a member.
+  int GetIndex(sym_t name) const {
+    auto it = table_->indexes_.find(name);
+    if (it == table_->indexes_.end() || it->second >= num_slots_) {
+      return -1;
+    }
+    return it->second;
+  }
+  sym_t GetName(int index) const { return table_->names_[index]; }
+  int GetNumSlots() const { return num_slots_; }
+
+  // Returns the shape with name appended as the last slot.
+  Shape *AddMember(sym_t name);
+  // Returns the shape without name. Other slots keep their order.
+  Shape *RemoveMember(sym_t name);
+
+private:
+  // Names of a chain of transitions. A shape uses the first num_slots_
+  // entries, and an AddMember() from the last shape of the chain appends
+  // to the table instead of copying it.
+  struct Table {
+    vector<sym_t> names_;
+    map<sym_t, int> indexes_;
+  };
+
+  Shape(Shape *root, Shape *parent, sym_t name);
+
+  Shape *root_;
+  Shape *parent_;
+  int num_slots_;
+  std::shared_ptr<Table> table_;
+  map<sym_t, std::unique_ptr<Shape> > transitions_;
+};
+
+}  // namespace vm
+
+#endif  // _vm_shape_h_
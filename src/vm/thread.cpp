@@ -5,6 +5,7 @@
 #include "fe/method.h"
 #include "fe/var_decl.h"
 #include "karuta/env.h"
+#include "vm/coroutine.h"
 #include "vm/executor/executor.h"
 #include "vm/insn.h"
 #include "vm/method.h"
@@ -19,8 +20,10 @@ string Thread::dbg_bytecode_;
 
 Thread::Thread(VM *vm, Thread *parent, Object *obj, Method *method, int index)
   : vm_(vm), parent_thread_(parent),
-    in_yield_(false), index_(index), busy_counter_(0) {
+    skip_next_yield_(false), in_unlocked_native_(false), index_(index),
+    busy_counter_(0) {
   stat_ = RUNNABLE;
+  coroutine_.reset(new Coroutine(&Thread::RunCoroutine, this));
   PushMethodFrame(obj, method);
   MaySetThreadIndex();
   busy_counter_limit_ = Env::GetDuration();
@@ -37,14 +40,31 @@ void Thread::SetByteCodeDebug(string flags) {
 }
 
 void Thread::Run() {
+  coroutine_->Resume();
+}
+
+void Thread::RunCoroutine(void *thr) {
+  ((Thread *)thr)->RunMain();
+}
+
+void Thread::RunMain() {
   while (method_stack_.size() > 0) {
     RunMethod();
-    if (!IsRunnable()) {
+    if (IsDone()) {
       return;
     }
+    if (!IsRunnable()) {
+      // e.g. import. Continues from here when this is resumed.
+      coroutine_->Suspend();
+    }
   }
   if (parent_thread_) {
-    parent_thread_->Resume();
+    if (vm_->IsParallel()) {
+      std::lock_guard<VMLock> lock(vm_->GetLock());
+      parent_thread_->Resume();
+    } else {
+      parent_thread_->Resume();
+    }
   }
   stat_ = DONE;
 }
@@ -53,17 +73,29 @@ void Thread::RunMethod() {
   MethodFrame *frame = CurrentMethodFrame();
   Method *method = frame->method_;
   executor::Executor executor(this, frame);
-  Profile *profile = vm_->GetProfile();
-  bool profile_enabled = profile->IsEnabled();
-  while (frame->pc_ < method->insns_.size()) {
-    if (profile_enabled) {
-      profile->Mark(method, frame->pc_);
-    }
-    Insn *insn = method->insns_[frame->pc_];
-    bool need_suspend = executor.ExecInsn(insn);
-    if (need_suspend) {
-      return;
+  bool need_suspend;
+  bool is_decoded = (Env::GetThreadedDispatch() &&
+		     method->decoded_insns_.size() == method->insns_.size());
+  if (vm_->IsParallel()) {
+    if (is_decoded) {
+      need_suspend = RunDecodedInsnsWithLock(frame, &executor);
+    } else {
+      std::lock_guard<VMLock> lock(vm_->GetLock());
+      if (method->IsTopLevel()) {
+	need_suspend = RunInsns<true>(frame, &executor);
+      } else {
+	need_suspend = RunInsns<false>(frame, &executor);
+      }
     }
+  } else if (is_decoded) {
+    need_suspend = RunDecodedInsns(frame, &executor);
+  } else if (method->IsTopLevel()) {
+    need_suspend = RunInsns<true>(frame, &executor);
+  } else {
+    need_suspend = RunInsns<false>(frame, &executor);
+  }
+  if (need_suspend) {
+    return;
   }
   PassReturnValues();
   if (ByteCodeDebugMode::IsEnabled(dbg_bytecode_)) {
@@ -77,6 +109,73 @@ void Thread::RunMethod() {
   PopMethodFrame();
 }
 
+bool Thread::RunDecodedInsns(MethodFrame *frame,
+			     executor::Executor *executor) {
+  Method *method = frame->method_;
+  Profile *profile = vm_->GetProfile();
+  bool profile_enabled = profile->IsEnabled();
+  size_t num_insns = method->decoded_insns_.size();
+  const DecodedInsn *decoded = method->decoded_insns_.data();
+  while (frame->pc_ < num_insns) {
+    if (profile_enabled) {
+      profile->Mark(method, frame->pc_);
+    }
+    bool need_suspend = executor->ExecDecodedInsn(decoded[frame->pc_]);
+    if (need_suspend) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Thread::RunDecodedInsnsWithLock(MethodFrame *frame,
+				     executor::Executor *executor) {
+  Method *method = frame->method_;
+  Profile *profile = vm_->GetProfile();
+  bool profile_enabled = profile->IsEnabled();
+  VMLock &lock = vm_->GetLock();
+  size_t num_insns = method->decoded_insns_.size();
+  const DecodedInsn *decoded = method->decoded_insns_.data();
+  while (frame->pc_ < num_insns) {
+    const DecodedInsn &d = decoded[frame->pc_];
+    bool need_suspend;
+    if (d.is_local_ && !profile_enabled) {
+      need_suspend = executor->ExecDecodedInsn(d);
+    } else if (d.insn_->op_ == OP_FUNCALL && !profile_enabled) {
+      // Takes the lock by itself.
+      need_suspend = executor->ExecFuncallInParallel(d);
+    } else {
+      std::lock_guard<VMLock> guard(lock);
+      if (profile_enabled) {
+	profile->Mark(method, frame->pc_);
+      }
+      need_suspend = executor->ExecDecodedInsn(d);
+    }
+    if (need_suspend) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<bool kTopLevel>
+bool Thread::RunInsns(MethodFrame *frame, executor::Executor *executor) {
+  Method *method = frame->method_;
+  Profile *profile = vm_->GetProfile();
+  bool profile_enabled = profile->IsEnabled();
+  while (frame->pc_ < method->insns_.size()) {
+    if (profile_enabled) {
+      profile->Mark(method, frame->pc_);
+    }
+    Insn *insn = method->insns_[frame->pc_];
+    bool need_suspend = executor->ExecInsn<kTopLevel>(insn);
+    if (need_suspend) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void Thread::Dump() const {
   DumpStream ds(cout);
   Dump(ds);
@@ -85,7 +184,7 @@ void Thread::Dump() const {
 void Thread::Dump(DumpStream &ds) const {
   MethodFrame *frame = CurrentMethodFrame();
   ds.os << "thread[" << index_ << "] stat=" << stat_
-	<< " yield=" << in_yield_ << " pc=" << frame->pc_ << "\n";
+	<< " pc=" << frame->pc_ << "\n";
 }
 
 bool Thread::IsRunnable() const {
@@ -105,22 +204,63 @@ void Thread::Exit() {
   stat_ = DONE;
 }
 
+void Thread::Release() {
+  CHECK(IsDone());
+  coroutine_.reset();
+  method_stack_.clear();
+  frames_.clear();
+  native_args_.clear();
+}
+
 void Thread::Resume() {
   CHECK(stat_ == SUSPENDED);
   stat_ = RUNNABLE;
+  vm_->EnqueueThread(this);
+}
+
+void Thread::Yield() {
+  if (vm_->SkipYield(this)) {
+    return;
+  }
+  vm_->Yield(this);
+  Block();
 }
 
-bool Thread::Yield() {
-  if (in_yield_) {
-    // This insn already issued yield. Proceed to the next insn.
-    CHECK(IsRunnable());
-    in_yield_ = false;
+void Thread::MayYield() {
+  if (skip_next_yield_) {
+    skip_next_yield_ = false;
+    return;
+  }
+  skip_next_yield_ = true;
+  Yield();
+}
+
+void Thread::Wait(uint64_t cycles) {
+  GetVM()->Wait(this, cycles);
+  Block();
+}
+
+void Thread::SetInUnlockedNative(bool b) {
+  in_unlocked_native_ = b;
+}
+
+void Thread::Block() {
+  if (vm_->IsParallel()) {
+    // Another worker may resume this thread.
+    VMLock &lock = vm_->GetLock();
+    int depth = lock.GetDepth();
+    // Thread safe natives run without the lock.
+    CHECK(depth == (in_unlocked_native_ ? 0 : 1));
+    if (depth == 1) {
+      lock.unlock();
+    }
+    coroutine_->Suspend();
+    if (depth == 1) {
+      lock.lock();
+    }
   } else {
-    CHECK(IsRunnable());
-    GetVM()->Yield(this);
-    in_yield_ = true;
+    coroutine_->Suspend();
   }
-  return in_yield_; // need suspend.
 }
 
 VM *Thread::GetVM() {
@@ -132,6 +272,10 @@ void Thread::SetReturnValueFromNativeMethod(const Value &value) {
   frame->returns_.push_back(value);
 }
 
+vector<Value> &Thread::NativeArgs() {
+  return native_args_;
+}
+
 bool Thread::IsRootThread() const {
   return (parent_thread_ == nullptr);
 }
@@ -151,6 +295,10 @@ void Thread::UserError() {
 bool Thread::OnJump() {
   busy_counter_++;
   if (busy_counter_limit_ > 0 && busy_counter_ > busy_counter_limit_) {
+    std::unique_lock<VMLock> lock(vm_->GetLock(), std::defer_lock);
+    if (vm_->IsParallel()) {
+      lock.lock();
+    }
     Status::os(Status::USER_ERROR)
       << "Busy loop detected. Killing the thread. "
       << "Increase the limit by --duration option, if necessary.";
@@ -167,17 +315,31 @@ void Thread::MayBlock() {
 }
 
 MethodFrame *Thread::PushMethodFrame(Object *obj, Method *method) {
-  MethodFrame *frame = new MethodFrame;
+  size_t depth = method_stack_.size();
+  if (depth == frames_.size()) {
+    frames_.emplace_back();
+  }
+  MethodFrame *frame = &frames_[depth];
   frame->method_ = method;
   frame->pc_ = 0;
   frame->obj_ = obj;
-  frame->reg_values_.resize(method->method_regs_.size());
-  for (size_t i = 0; i < method->method_regs_.size(); ++i) {
-    Value &local_val = frame->reg_values_[i];
-    Register *reg = method->method_regs_[i];
-    local_val.type_ = reg->type_.value_type_;
-    local_val.enum_val_.enum_type = reg->type_.enum_type_;
-    local_val.num_type_ = reg->type_.width_;
+  frame->returns_.clear();
+  frame->objs_.clear();
+  size_t num_regs = method->method_regs_.size();
+  if (method->reg_values_template_.size() == num_regs) {
+    // Reuses the storage of the previous frame at this depth.
+    frame->reg_values_.assign(method->reg_values_template_.begin(),
+			      method->reg_values_template_.end());
+  } else {
+    frame->reg_values_.resize(num_regs);
+    for (size_t i = 0; i < num_regs; ++i) {
+      Value &local_val = frame->reg_values_[i];
+      Register *reg = method->method_regs_[i];
+      local_val = Value();
+      local_val.type_ = reg->type_.value_type_;
+      local_val.enum_val_.enum_type = reg->type_.enum_type_;
+      local_val.num_type_ = reg->type_.width_;
+    }
   }
   method_stack_.push_back(frame);
   return frame;
@@ -199,17 +361,32 @@ void Thread::PassReturnValues() {
   if (!returns) {
     return;
   }
+  // Writes to the destination registers of the caller directly, if
+  // it is waiting at a *_DONE insn. Otherwise via returns_.
+  Insn *done_insn = nullptr;
+  Method *parent_method = parent_frame->method_;
+  if (parent_frame->pc_ < parent_method->insns_.size()) {
+    Insn *insn = parent_method->insns_[parent_frame->pc_];
+    if (insn->op_ == OP_FUNCALL_DONE ||
+	insn->op_ == OP_FUNCALL_DONE_WITH_CHECK ||
+	insn->op_ == OP_MAY_WITH_TYPE_DONE) {
+      done_insn = insn;
+    }
+  }
   for (size_t i = 0; i < returns->decls.size(); ++i) {
     Value &value = frame->reg_values_[base + i];
-    parent_frame->returns_.push_back(value);
+    if (done_insn == nullptr) {
+      parent_frame->returns_.push_back(value);
+    } else if (i < done_insn->dst_regs_.size()) {
+      Register *dst = done_insn->dst_regs_[i];
+      parent_frame->reg_values_[dst->id_] = value;
+    }
   }
 }
 
 void Thread::PopMethodFrame() {
   CHECK(method_stack_.size() > 0) << "attempting to pop from empty method stack.";
-  MethodFrame *frame = CurrentMethodFrame();
   method_stack_.pop_back();
-  delete frame;
 }
 
 MethodFrame *Thread::CurrentMethodFrame() const {
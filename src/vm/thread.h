@@ -3,9 +3,17 @@
 #define _vm_thread_h_
 
 #include "vm/common.h"
+#include "vm/method_frame.h"
+
+#include <atomic>
+#include <deque>
 
 namespace vm {
 
+namespace executor {
+class Executor;
+}  // namespace executor
+
 class Thread {
 public:
   Thread(VM *vm, Thread *parent, Object *obj, Method *method, int index);
@@ -18,8 +26,21 @@ public:
   bool IsDone() const;
   void Suspend();
   void Exit();
+  // Frees the stack and the frames after the thread is done.
+  void Release();
   void Resume();
-  bool Yield();
+  void Yield();
+  // For yield insns. Loops have yield insns before both of if and goto,
+  // so this yields at every other call (once per iteration).
+  void MayYield();
+  void Wait(uint64_t cycles);
+  // Called by native methods after Suspend(). Returns when the thread is
+  // resumed and scheduled again, so the method can continue from there
+  // without executing the insn again.
+  void Block();
+  // Set while a thread safe native method runs without the VM lock
+  // (--workers).
+  void SetInUnlockedNative(bool b);
 
   VM *GetVM();
   static void SetByteCodeDebug(string flags);
@@ -27,6 +48,8 @@ public:
   MethodFrame *PushMethodFrame(Object *obj, Method *method);
 
   void SetReturnValueFromNativeMethod(const Value &value);
+  // Reused buffer to pass arguments to native methods.
+  vector<Value> &NativeArgs();
   bool IsRootThread() const;
 
   // For GC.
@@ -44,7 +67,16 @@ private:
     RUNNABLE, SUSPENDED, DONE
   };
 
+  static void RunCoroutine(void *thr);
+  void RunMain();
   void RunMethod();
+  // Returns true if the execution is suspended.
+  bool RunDecodedInsns(MethodFrame *frame, executor::Executor *executor);
+  // Runs non local insns under the lock of VM (--workers).
+  bool RunDecodedInsnsWithLock(MethodFrame *frame,
+			       executor::Executor *executor);
+  template<bool kTopLevel>
+  bool RunInsns(MethodFrame *frame, executor::Executor *executor);
   void PassReturnValues();
   void PopMethodFrame();
   MethodFrame *CurrentMethodFrame() const;
@@ -54,11 +86,19 @@ private:
   static string dbg_bytecode_;
 
   VM *vm_;
-  Stat stat_;
+  // Read without the lock by the worker running this thread.
+  std::atomic<Stat> stat_;
   Thread *parent_thread_;
 
   vector<MethodFrame*> method_stack_;
-  bool in_yield_;
+  // Frames are reused by calls at the same depth.
+  std::deque<MethodFrame> frames_;
+  vector<Value> native_args_;
+  // Each thread runs on its own stack.
+  std::unique_ptr<Coroutine> coroutine_;
+  bool skip_next_yield_;
+  // Running a thread safe native method without the VM lock.
+  bool in_unlocked_native_;
   int index_;
   long busy_counter_;
   long busy_counter_limit_;
@@ -4,37 +4,45 @@
 
 namespace vm {
 
-void ThreadQueue::AddThread(Thread *thr) {
+void ThreadQueue::Wait(Thread *thr) {
   CHECK(thr->IsRunnable());
-  waiters.insert(thr);
+  waiters.push_back(thr);
   thr->Suspend();
+  thr->Block();
+}
+
+void ThreadQueue::Wait(Thread *thr, std::unique_lock<std::mutex> *lock) {
+  CHECK(thr->IsRunnable());
+  waiters.push_back(thr);
+  thr->Suspend();
+  // Resume() by another worker before Block() is fine, since the thread
+  // runs again only in the next round.
+  lock->unlock();
+  thr->Block();
+  lock->lock();
 }
 
 void ThreadQueue::ResumeOne() {
   if (waiters.size() == 0) {
     return;
   }
-  Thread *thr = *(waiters.begin());
+  Thread *thr = waiters.front();
   CHECK(!thr->IsRunnable());
-  waiters.erase(thr);
+  waiters.pop_front();
   thr->Resume();
 }
 
+void ThreadQueue::Resume(int num) {
+  for (int i = 0; i < num && waiters.size() > 0; ++i) {
+    ResumeOne();
+  }
+}
+
 void ThreadQueue::ResumeAll() {
-  notified.clear();
   for (Thread *t : waiters) {
     t->Resume();
-    notified.insert(t);
   }
   waiters.clear();
 }
 
-bool ThreadQueue::ClearIfNotified(Thread *thr) {
-  if (notified.find(thr) != notified.end()) {
-    notified.erase(thr);
-    return true;
-  }
-  return false;
-}
-
 }  // namespace vm
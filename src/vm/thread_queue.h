@@ -4,20 +4,26 @@
 
 #include "vm/common.h"
 
-#include <set>
+#include <deque>
+#include <mutex>
 
 namespace vm {
 
+// Guarded by the lock of the owner object (or the VM lock).
 class ThreadQueue {
 public:
-  void AddThread(Thread *thr);
+  // Blocks the thread until it's resumed.
+  void Wait(Thread *thr);
+  // Releases the lock of the owner while blocked.
+  void Wait(Thread *thr, std::unique_lock<std::mutex> *lock);
   void ResumeOne();
+  // Resumes up to num threads.
+  void Resume(int num);
   void ResumeAll();
-  bool ClearIfNotified(Thread *thr);
 
 private:
-  std::set<Thread *> waiters;
-  std::set<Thread *> notified;
+  // Resumed in the order of arrival.
+  std::deque<Thread *> waiters;
 };
 
 }  // namespace vm
@@ -45,8 +45,8 @@ void ThreadWrapper::Run(VM *vm, Object *obj) {
 void ThreadWrapper::GetThreadEntryMethods(Object *obj,
 					  vector<ThreadEntry> *methods,
 					  bool with_soft_thread) {
-  for (auto it : obj->members_) {
-    Value &value = it.second;
+  for (int i = 0; i < obj->GetNumMembers(); ++i) {
+    Value &value = obj->GetMemberValue(i);
     if (value.type_ == Value::OBJECT && value.object_ == obj) {
       // excluding self.
       continue;
@@ -59,23 +59,25 @@ void ThreadWrapper::GetThreadEntryMethods(Object *obj,
       continue;
     }
     ThreadEntry entry = data->entry;
-    entry.thread_name = sym_str(it.first);
+    entry.thread_name = sym_str(obj->GetMemberName(i));
     methods->push_back(entry);
   }
 }
 
 void ThreadWrapper::DeleteThreadByMethodName(Object *obj, const string &name) {
-  auto members = obj->members_;
-  for (auto it : members) {
-    Value &value = it.second;
-    ThreadWrapperData *data = GetData(value);
+  vector<sym_t> names;
+  for (int i = 0; i < obj->GetNumMembers(); ++i) {
+    ThreadWrapperData *data = GetData(obj->GetMemberValue(i));
     if (data == nullptr) {
       continue;
     }
     if (data->entry.method_name == name) {
-      obj->members_.erase(it.first);
+      names.push_back(obj->GetMemberName(i));
     }
   }
+  for (sym_t n : names) {
+    obj->RemoveValue(n);
+  }
 }
 
 ThreadWrapperData *ThreadWrapper::GetData(Value &value) {
@@ -0,0 +1,52 @@
+#include "vm/timer_wheel.h"
+
+namespace vm {
+
+TimerWheel::TimerWheel() : now_(0), num_near_events_(0) {
+  slots_.resize(kNumSlots);
+}
+
+void TimerWheel::Add(uint64_t time, Thread *thr) {
+  CHECK(time >= now_);
+  if (time - now_ < kNumSlots) {
+    slots_[time % kNumSlots].push_back(thr);
+    ++num_near_events_;
+  } else {
+    far_events_.insert(std::make_pair(time, thr));
+  }
+}
+
+bool TimerWheel::IsEmpty() const {
+  return num_near_events_ == 0 && far_events_.empty();
+}
+
+uint64_t TimerWheel::GetNextTime() const {
+  if (num_near_events_ > 0) {
+    for (uint64_t t = now_; t < now_ + kNumSlots; ++t) {
+      if (!slots_[t % kNumSlots].empty()) {
+	return t;
+      }
+    }
+  }
+  CHECK(!far_events_.empty());
+  return far_events_.begin()->first;
+}
+
+uint64_t TimerWheel::PopEvents(vector<Thread *> *threads) {
+  now_ = GetNextTime();
+  // Slots before now_ are empty, so they can take far events.
+  while (!far_events_.empty() &&
+	 far_events_.begin()->first - now_ < kNumSlots) {
+    auto it = far_events_.begin();
+    slots_[it->first % kNumSlots].push_back(it->second);
+    ++num_near_events_;
+    far_events_.erase(it);
+  }
+  vector<Thread *> &slot = slots_[now_ % kNumSlots];
+  threads->insert(threads->end(), slot.begin(), slot.end());
+  num_near_events_ -= slot.size();
+  slot.clear();
+  return now_;
+}
+
+}  // namespace vm
@@ -0,0 +1,38 @@
+// -*- C++ -*-
+#ifndef _vm_timer_wheel_h_
+#define _vm_timer_wheel_h_
+
+#include "vm/common.h"
+
+#include <map>
+
+namespace vm {
+
+// Threads waiting until given virtual times.
+// Events within kNumSlots cycles from the current time are kept in the
+// slots of the wheel (one time per slot) and farther ones in a map.
+class TimerWheel {
+public:
+  TimerWheel();
+
+  // time should not be earlier than the time given to last PopEvents().
+  void Add(uint64_t time, Thread *thr);
+  bool IsEmpty() const;
+  // Returns the earliest time of the events. The wheel should not be empty.
+  uint64_t GetNextTime() const;
+  // Moves the current time to the earliest event and appends the threads
+  // waiting for it. Returns the new current time.
+  uint64_t PopEvents(vector<Thread *> *threads);
+
+private:
+  static const int kNumSlots = 256;
+
+  uint64_t now_;
+  int num_near_events_;
+  vector<vector<Thread *> > slots_;
+  std::multimap<uint64_t, Thread *> far_events_;
+};
+
+}  // namespace vm
+
+#endif  // _vm_timer_wheel_h_
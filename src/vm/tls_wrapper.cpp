@@ -21,9 +21,9 @@ public:
   }
 
   virtual void Scan(GC *gc) {
-    gc->ScanObject(baseValue.object_);
-    for (auto it : values) {
-      gc->ScanObject(it.second.object_);
+    gc->MarkValue(baseValue);
+    for (auto &it : values) {
+      gc->MarkValue(it.second);
     }
   }
 
@@ -71,6 +71,8 @@ Object *TlsWrapper::Copy(VM *vm, Object *tls_obj) {
 Value *TlsWrapper::GetValue(Object *tls_obj, Thread *thr) {
   TlsWrapperData *data = (TlsWrapperData *)tls_obj->object_specific_.get();
   CHECK(data);
+  // The caller may modify the value.
+  tls_obj->WriteBarrier();
   if (thr == nullptr) {
     return &data->baseValue;
   }
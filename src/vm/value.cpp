@@ -10,8 +10,10 @@
 
 namespace vm {
 
-Value::Value() : type_(NONE), is_const_(false), method_(nullptr),
-		 object_(nullptr), type_object_name_(sym_null) {
+Value::Value() : type_(NONE), is_const_(false), object_(nullptr),
+		 type_object_name_(sym_null) {
+  enum_val_.val = 0;
+  enum_val_.enum_type = nullptr;
 }
 
 void Value::Dump() const {
@@ -64,7 +66,7 @@ void Value::Dump(ostream &os) const {
     os << "object_array[" << ArrayWrapper::ToString(object_) << "]";
     break;
   default:
-    CHECK(false) << "unknown value type" << type_;
+    CHECK(false) << "unknown value type" << (int)type_;
     break;
   }
   if (is_const_) {
@@ -22,7 +22,7 @@ public:
   bool IsObjectType() const;
   void CopyDataFrom(const Value &src, const iroha::NumericWidth &width);
 
-  enum ValueType {
+  enum ValueType : uint8_t {
     NONE,
     NUM,
     METHOD,
@@ -38,23 +38,52 @@ public:
 
   static const char *TypeName(enum ValueType type);
 
+  // Fields are ordered to pack the small ones together and to keep the
+  // lower words of num_ in the same cache line as the header.
   enum ValueType type_;
   bool is_const_;
-
   // for NUM
-  iroha::NumericValue num_;
   iroha::NumericWidth num_type_;
-  // for METHOD
-  Method *method_;
-  // for ENUM_ITEM
-  EnumVal enum_val_;
-  // for ANNOTATION
-  Annotation *annotation_;
   // object itself for OBJECT, ENUM_TYPE, INT_ARRAY and OBJECT_ARRAY
   // (IsObjectType()==true).
   // can be numeric type object for NUM.
   Object *object_;
   sym_t type_object_name_;
+  // Only one of them is used depending on type_.
+  union {
+    // for METHOD
+    Method *method_;
+    // for ENUM_ITEM
+    EnumVal enum_val_;
+    // for ANNOTATION
+    Annotation *annotation_;
+  };
+  // for NUM
+  // iroha keeps up to 128 bits inline (16 bytes). Wider values are out of
+  // line in the storage allocated by Numeric::MayPopulateStorage().
+  iroha::NumericValue num_;
+};
+
+// Read only view of consecutive Values without copying them.
+// e.g. arguments to a native method.
+class ValueSpan {
+public:
+  ValueSpan(const Value *values, size_t size)
+    : values_(values), size_(size) {
+  }
+  ValueSpan(const vector<Value> &values)
+    : values_(values.data()), size_(values.size()) {
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const Value &operator[](size_t i) const { return values_[i]; }
+  const Value *begin() const { return values_; }
+  const Value *end() const { return values_ + size_; }
+
+private:
+  const Value *values_;
+  size_t size_;
 };
 
 }  // namespace vm
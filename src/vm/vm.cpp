@@ -14,13 +14,38 @@
 #include "vm/profile.h"
 #include "vm/object.h"
 #include "vm/opcode.h"
+#include "vm/shape.h"
 #include "vm/thread.h"
+#include "vm/timer_wheel.h"
+#include "vm/worker_pool.h"
 
 namespace vm {
 
-VM::VM() : tick_count_(0) {
+// Accessed only by the non inline methods below, so that the address is
+// computed again after a coroutine moves to another OS thread.
+static thread_local int vm_lock_depth;
+
+void VMLock::lock() {
+  mu_.lock();
+  ++vm_lock_depth;
+}
+
+void VMLock::unlock() {
+  --vm_lock_depth;
+  mu_.unlock();
+}
+
+int VMLock::GetDepth() const {
+  return vm_lock_depth;
+}
+
+VM::VM()
+  : context_switch_count_(0), duration_(0), virtual_time_(0) {
   methods_.reset(new Pool<Method>());
+  gc_.reset(new vm::GC(this, &threads_, methods_.get()));
   profile_.reset(new Profile());
+  root_shape_.reset(new Shape());
+  timer_wheel_.reset(new TimerWheel());
 
   root_object_ = NewEmptyObject();
   InstallBoolType();
@@ -30,32 +55,85 @@ VM::VM() : tick_count_(0) {
 
 VM::~VM() {
   STLDeleteValues(&threads_);
-  STLDeleteValues(&objects_);
+  STLDeleteValues(&retired_threads_);
+  gc_.reset();
 }
 
 void VM::Run() {
   bool may_continue = true;
-  long duration = Env::GetDuration();
-  long context_switch_count = 0;
+  duration_ = Env::GetDuration();
+  context_switch_count_ = 0;
   bool expired = false;
+  if (Env::GetNumWorkers() > 0 && worker_pool_.get() == nullptr) {
+    worker_pool_.reset(new WorkerPool(Env::GetNumWorkers()));
+  }
   while (may_continue) {
+    // Every thread is suspended between the rounds.
+    gc_->MaybeCollect();
     may_continue = false;
-    for (Thread *thr : threads_) {
-      if (thr->IsRunnable()) {
-	thr->Run();
-	may_continue = true;
+    // Threads enqueued in this round run in the next round.
+    size_t num_runnables = run_queue_.size();
+    bool has_done = false;
+    if (IsParallel()) {
+      vector<Thread *> threads;
+      set<Thread *> seen;
+      for (size_t i = 0; i < num_runnables; ++i) {
+	Thread *thr = run_queue_.front();
+	run_queue_.pop_front();
+	if (thr->IsRunnable() && seen.insert(thr).second) {
+	  threads.push_back(thr);
+	}
       }
+      worker_pool_->RunThreads(threads);
+      may_continue = (threads.size() > 0);
+      for (Thread *thr : threads) {
+	has_done |= thr->IsDone();
+      }
+    } else {
+      for (size_t i = 0; i < num_runnables; ++i) {
+	Thread *thr = run_queue_.front();
+	run_queue_.pop_front();
+	// Finished or suspended threads can be left in the queue.
+	if (thr->IsRunnable()) {
+	  thr->Run();
+	  may_continue = true;
+	  has_done |= thr->IsDone();
+	}
+      }
+    }
+    if (has_done) {
+      RetireThreads();
     }
     if (!may_continue) {
       if (yielded_threads_.size() > 0) {
-	Thread *thr = *(yielded_threads_.begin());
-	yielded_threads_.erase(thr);
-	thr->Resume();
+	// Only yielded threads remain. They take a cycle, so the threads
+	// waiting until then run before them.
+	++virtual_time_;
+	vector<Thread *> threads;
+	while (!timer_wheel_->IsEmpty() &&
+	       timer_wheel_->GetNextTime() <= virtual_time_) {
+	  timer_wheel_->PopEvents(&threads);
+	}
+	for (Thread *thr : threads) {
+	  thr->Resume();
+	}
+	for (Thread *thr : yielded_threads_) {
+	  thr->Resume();
+	}
+	yielded_threads_.clear();
+	may_continue = true;
+      } else if (!timer_wheel_->IsEmpty()) {
+	// Every thread is idle. Jumps to the next event.
+	vector<Thread *> threads;
+	virtual_time_ = timer_wheel_->PopEvents(&threads);
+	for (Thread *thr : threads) {
+	  thr->Resume();
+	}
 	may_continue = true;
       }
     }
-    context_switch_count++;
-    if (duration > 0 && context_switch_count > duration) {
+    context_switch_count_++;
+    if (duration_ > 0 && context_switch_count_ > duration_) {
       Status::os(Status::INFO) << "Simulation expired";
       may_continue = false;
       expired = true;
@@ -77,16 +155,76 @@ void VM::AddThreadFromMethod(Thread *parent, Object *object, Method *method,
 			     int index) {
   compiler::Compiler::CompileMethod(this, object, method);
   Thread *thread = new Thread(this, parent, object, method, index);
-  threads_.insert(thread);
+  threads_.push_back(thread);
+  EnqueueThread(thread);
+}
+
+void VM::RetireThreads() {
+  // A finished thread has resumed its parent and is not in any queue.
+  size_t n = 0;
+  for (Thread *thr : threads_) {
+    if (thr->IsDone()) {
+      thr->Release();
+      retired_threads_.push_back(thr);
+    } else {
+      threads_[n++] = thr;
+    }
+  }
+  threads_.resize(n);
+}
+
+bool VM::SkipYield(Thread *thr) {
+  // Waiting threads may run after a yield.
+  if (IsParallel() || !run_queue_.empty() || !yielded_threads_.empty() ||
+      !timer_wheel_->IsEmpty()) {
+    return false;
+  }
+  // Yielding takes 2 rounds; the one ending now and an empty one which
+  // resumes this thread after a cycle.
+  if (duration_ > 0 && context_switch_count_ + 2 > duration_) {
+    return false;
+  }
+  context_switch_count_ += 2;
+  ++virtual_time_;
+  // Nothing is allocated between the safe points of the 2 rounds.
+  gc_->MaybeCollect();
+  thr->MayBlock();
+  return true;
 }
 
 void VM::Yield(Thread *thr) {
   thr->Suspend();
-  yielded_threads_.insert(thr);
+  yielded_threads_.push_back(thr);
+}
+
+void VM::Wait(Thread *thr, uint64_t cycles) {
+  thr->Suspend();
+  timer_wheel_->Add(virtual_time_ + cycles, thr);
+}
+
+void VM::EnqueueThread(Thread *thr) {
+  std::lock_guard<std::mutex> lock(run_queue_lock_);
+  run_queue_.push_back(thr);
+}
+
+bool VM::IsParallel() const {
+  return worker_pool_.get() != nullptr;
+}
+
+void VM::StopWorkers() {
+  worker_pool_.reset();
+}
+
+VMLock &VM::GetLock() {
+  return lock_;
 }
 
 void VM::GC() {
-  GC::Run(this, &threads_, &objects_);
+  gc_->Collect(true);
+}
+
+vm::GC *VM::GetGC() const {
+  return gc_.get();
 }
 
 void VM::InstallBoolType() {
@@ -163,17 +301,19 @@ Method *VM::NewMethod(bool is_toplevel) {
 }
 
 Object *VM::NewEmptyObject() {
-  Object *object = new Object(this);
-  objects_.insert(object);
-  return object;
+  return gc_->NewObject();
 }
 
 Profile *VM::GetProfile() const {
   return profile_.get();
 }
 
-int VM::GetTickCount() {
-  return ++tick_count_;
+Shape *VM::GetRootShape() const {
+  return root_shape_.get();
+}
+
+uint64_t VM::GetTickCount() {
+  return virtual_time_;
 }
 
 }  // namespace vm
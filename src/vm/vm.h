@@ -5,12 +5,28 @@
 #include "base/pool.h"
 #include "vm/common.h"
 
+#include <deque>
+#include <mutex>
 #include <set>
 
 using std::set;
 
 namespace vm {
 
+// Taken by the workers to access the state shared among threads
+// (--workers). Recursive, and counts the depth on each OS thread so that
+// a thread can check it before switching the stack.
+class VMLock {
+public:
+  void lock();
+  void unlock();
+  // Depth on the calling OS thread.
+  int GetDepth() const;
+
+private:
+  std::recursive_mutex mu_;
+};
+
 class VM {
 public:
   VM();
@@ -19,14 +35,33 @@ public:
   void Run();
   void AddThreadFromMethod(Thread *parent, Object *object, Method *method,
 			   int index);
+  // Runs the thread again after the other runnable threads. A cycle
+  // passes when only yielded threads are left.
   void Yield(Thread *thr);
+  // Returns true if a yield of the running thread can be skipped, since
+  // the thread would be the next to run. Accounts the rounds and the cycle
+  // in between.
+  bool SkipYield(Thread *thr);
+  // Suspends the thread until the virtual time advances by cycles.
+  void Wait(Thread *thr, uint64_t cycles);
+  // Called when the thread becomes runnable.
+  void EnqueueThread(Thread *thr);
+  // True if threads run on the worker pool (--workers).
+  bool IsParallel() const;
+  VMLock &GetLock();
+  // Joins the worker threads (e.g. before fork()). Next Run() starts
+  // them again.
+  void StopWorkers();
+  // Full collection.
   void GC();
+  vm::GC *GetGC() const;
   IntArray *GetDefaultMemory();
 
   Method *NewMethod(bool is_toplevel);
   Object *NewEmptyObject();
   Profile *GetProfile() const;
-  int GetTickCount();
+  Shape *GetRootShape() const;
+  uint64_t GetTickCount();
 
   // root of the objects.
   Object *root_object_;
@@ -38,14 +73,35 @@ public:
   Object *default_mem_;
 
 private:
-  set<Thread*> threads_;
-  set<Thread*> yielded_threads_;
+  // Moves finished threads from threads_ to retired_threads_.
+  void RetireThreads();
+
+  // All live threads in the order of creation.
+  vector<Thread*> threads_;
+  // Finished threads without their stacks and frames. Kept until the VM
+  // is deleted, since thread local values are keyed by Thread*.
+  vector<Thread*> retired_threads_;
+  // Runnable threads in the order to run.
+  std::deque<Thread*> run_queue_;
+  // Threads are resumed by natives without the VM lock (e.g. channels).
+  std::mutex run_queue_lock_;
+  // One of these resumes when no thread is runnable.
+  std::deque<Thread*> yielded_threads_;
+  // Rounds in the current Run() and the limit (--duration).
+  long context_switch_count_;
+  long duration_;
 
   std::unique_ptr<Pool<Method> > methods_;
   std::unique_ptr<Profile> profile_;
-  set<Object*> objects_;
+  std::unique_ptr<Shape> root_shape_;
+  std::unique_ptr<WorkerPool> worker_pool_;
+  VMLock lock_;
+  // Owns all objects.
+  std::unique_ptr<vm::GC> gc_;
 
-  int tick_count_;
+  // Advances only when every thread is idle.
+  uint64_t virtual_time_;
+  std::unique_ptr<TimerWheel> timer_wheel_;
 
   void InstallBoolType();
   void InstallObjects();
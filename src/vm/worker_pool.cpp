@@ -0,0 +1,91 @@
+#include "vm/worker_pool.h"
+
+#include "vm/thread.h"
+
+namespace vm {
+
+WorkerPool::WorkerPool(int num_workers)
+  : generation_(0), num_running_(0), shutdown_(false) {
+  for (int i = 0; i < num_workers; ++i) {
+    queues_.emplace_back(new WorkQueue);
+  }
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(&WorkerPool::WorkerMain, this, i);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    shutdown_ = true;
+  }
+  start_cond_.notify_all();
+  for (std::thread &w : workers_) {
+    w.join();
+  }
+}
+
+void WorkerPool::RunThreads(const vector<Thread *> &threads) {
+  if (threads.empty()) {
+    return;
+  }
+  for (size_t i = 0; i < threads.size(); ++i) {
+    WorkQueue *q = queues_[i % queues_.size()].get();
+    std::unique_lock<std::mutex> lock(q->mu_);
+    q->threads_.push_back(threads[i]);
+  }
+  std::unique_lock<std::mutex> lock(mu_);
+  num_running_ = workers_.size();
+  ++generation_;
+  start_cond_.notify_all();
+  done_cond_.wait(lock, [this] { return num_running_ == 0; });
+}
+
+void WorkerPool::WorkerMain(int index) {
+  int generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      start_cond_.wait(lock, [this, generation] {
+	  return shutdown_ || generation_ != generation;
+	});
+      if (shutdown_) {
+	return;
+      }
+      generation = generation_;
+    }
+    Thread *thr;
+    while ((thr = TakeThread(index)) != nullptr) {
+      thr->Run();
+    }
+    std::unique_lock<std::mutex> lock(mu_);
+    --num_running_;
+    if (num_running_ == 0) {
+      done_cond_.notify_one();
+    }
+  }
+}
+
+Thread *WorkerPool::TakeThread(int index) {
+  int num_queues = queues_.size();
+  for (int i = 0; i < num_queues; ++i) {
+    WorkQueue *q = queues_[(index + i) % num_queues].get();
+    std::unique_lock<std::mutex> lock(q->mu_);
+    if (q->threads_.empty()) {
+      continue;
+    }
+    Thread *thr;
+    if (i == 0) {
+      thr = q->threads_.front();
+      q->threads_.pop_front();
+    } else {
+      // Steals from the other end.
+      thr = q->threads_.back();
+      q->threads_.pop_back();
+    }
+    return thr;
+  }
+  return nullptr;
+}
+
+}  // namespace vm
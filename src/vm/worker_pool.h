@@ -0,0 +1,46 @@
+// -*- C++ -*-
+#ifndef _vm_worker_pool_h_
+#define _vm_worker_pool_h_
+
+#include "vm/common.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace vm {
+
+// Runs vm::Threads on OS threads. Each worker has its own queue and
+// steals from the others when the queue is empty.
+class WorkerPool {
+public:
+  WorkerPool(int num_workers);
+  ~WorkerPool();
+
+  // Returns when every thread is suspended or done.
+  void RunThreads(const vector<Thread *> &threads);
+
+private:
+  struct WorkQueue {
+    std::mutex mu_;
+    std::deque<Thread *> threads_;
+  };
+
+  void WorkerMain(int index);
+  Thread *TakeThread(int index);
+
+  vector<std::unique_ptr<WorkQueue> > queues_;
+  vector<std::thread> workers_;
+  std::mutex mu_;
+  std::condition_variable start_cond_;
+  std::condition_variable done_cond_;
+  int generation_;
+  int num_running_;
+  bool shutdown_;
+};
+
+}  // namespace vm
+
+#endif  // _vm_worker_pool_h_
@@ -69,6 +69,9 @@ def ReadTestInfo(fn):
         m = re.search("KARUTA_TIMEOUT: (\d+)", line)
         if m:
             test_info["karuta_timeout"] = int(m.group(1))
+        m = re.search("KARUTA_FLAGS: (.+)", line)
+        if m:
+            test_info["karuta_flags"] = m.group(1)
         m = re.search("KARUTA_EXPECT_ABORT:", line)
         if m:
             test_info["exp_abort"] = 1
@@ -160,6 +163,8 @@ def GetKarutaCommand(source_fn, tf, test_info):
     cmd += " --root " + tmp_prefix
     cmd += " --timeout " + timeout + " "
     cmd += " --print_exit_status "
+    if "karuta_flags" in test_info:
+        cmd += " " + test_info["karuta_flags"] + " "
     if "self_shell" in test_info:
         cmd += " --compile --with_shell "
     else:
@@ -1,6 +1,6 @@
 #
 EXTRA = ["QA", "imported_file.karuta", "run-test", "resource.v", "test_tb.v",
-         "test_files.py"]
+         "test_files.py", "fe_misc/sweep.conf"]
 
 # see file QA to see category.
 default_tests = ["fe_error/misc.karuta",
@@ -10,14 +10,17 @@ default_tests = ["fe_error/misc.karuta",
                  "fe_lang/import_file.karuta", "fe_lang/load.karuta", "fe_lang/for.karuta",
                  "fe_lang/funcall.karuta", "fe_lang/if.karuta", "fe_lang/string.karuta",
                  "fe_lang/decl.karuta", "fe_lang/scope.karuta", "fe_lang/pipe.karuta",
-                 "fe_lang/while.karuta",
+                 "fe_lang/channel_burst.karuta", "fe_lang/pipe_workers.karuta",
+                 "fe_lang/while.karuta", "fe_lang/bytecode_opt.karuta",
                  "fe_misc/errors.karuta", "fe_misc/tb.karuta",
                  "fe_misc/hello.karuta", "fe_misc/parser.karuta",
-                 "fe_misc/misc.karuta",
-                 "fe_obj/object.karuta", "fe_obj/this_obj.karuta", "fe_obj/thread.karuta",
+                 "fe_misc/misc.karuta", "fe_misc/sweep.karuta",
+                 "fe_obj/gc.karuta", "fe_obj/object.karuta", "fe_obj/this_obj.karuta", "fe_obj/thread.karuta",
+                 "fe_obj/wait.karuta",
                  "fe_typeobj/basic.karuta",
                  "fe_value/basic.karuta", "fe_value/numeric.karuta",
                  "fe_value/false.karuta", "fe_value/array.karuta",
+                 "fe_value/array_ops.karuta",
                  "lib_fp/fp16rmul.karuta",
                  "lib_fp/fp16baddsub.karuta",
                  "lib_fp/fp16bmul.karuta",